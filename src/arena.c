@@ -0,0 +1,119 @@
+/**
+ * Project name: Imperative language IFJ20 compiler implementation
+ * Název projektu: Implementace překladače imperativního jazyka IFJ20
+ *
+ * @brief Arena (region) allocator implementation for the parser objects
+ *
+ * @author Petr Kabelka <xkabel09 at stud.fit.vutbr.cz>
+ */
+
+#include <string.h>
+#include "arena.h"
+
+#define ALIGN (sizeof(((arena_block*)0)->data[0]))
+
+void arena_init(arena *a)
+{
+    a->head = NULL;
+}
+
+void *arena_alloc(arena *a, size_t size)
+{
+    size = (size + ALIGN - 1) / ALIGN * ALIGN;
+
+    arena_block *block = a->head;
+    if (block == NULL || block->size - block->used < size)
+    {
+        size_t block_size = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+        if ((block = malloc(sizeof(arena_block) + block_size)) == NULL)
+        {
+            return NULL;
+        }
+        block->used = 0;
+        block->size = block_size;
+
+        // an oversized block is full right away, keep filling the current one
+        if (a->head != NULL && block_size > ARENA_BLOCK_SIZE)
+        {
+            block->next = a->head->next;
+            a->head->next = block;
+        }
+        else
+        {
+            block->next = a->head;
+            a->head = block;
+        }
+    }
+
+    void *ptr = (char*)block->data + block->used;
+    block->used += size;
+    return ptr;
+}
+
+void *arena_alloc_exact(arena *a, size_t size)
+{
+    size = (size + ALIGN - 1) / ALIGN * ALIGN;
+
+    arena_block *block = malloc(sizeof(arena_block) + size);
+    if (block == NULL)
+    {
+        return NULL;
+    }
+    block->used = size;
+    block->size = size;
+
+    // the block is full right away, keep filling the current one
+    if (a->head != NULL)
+    {
+        block->next = a->head->next;
+        a->head->next = block;
+    }
+    else
+    {
+        block->next = NULL;
+        a->head = block;
+    }
+    return block->data;
+}
+
+char *arena_strndup(arena *a, const char *s, size_t len)
+{
+    char *copy = arena_alloc(a, len + 1);
+    if (copy == NULL)
+    {
+        return NULL;
+    }
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+void arena_reset(arena *a)
+{
+    if (a->head == NULL)
+    {
+        return;
+    }
+
+    arena_block *block = a->head->next;
+    while (block != NULL)
+    {
+        arena_block *next = block->next;
+        free(block);
+        block = next;
+    }
+    a->head->next = NULL;
+    a->head->used = 0;
+}
+
+void arena_free(arena *a)
+{
+    arena_block *block = a->head;
+    while (block != NULL)
+    {
+        arena_block *next = block->next;
+        free(block);
+        block = next;
+    }
+    a->head = NULL;
+}
@@ -0,0 +1,88 @@
+/**
+ * Project name: Imperative language IFJ20 compiler implementation
+ * Název projektu: Implementace překladače imperativního jazyka IFJ20
+ *
+ * @brief Arena (region) allocator interface for the parser objects
+ *
+ * Objects are carved out of large blocks by bumping a pointer and are never
+ * freed one by one, the whole arena is reset or freed at once.
+ *
+ * @author Petr Kabelka <xkabel09 at stud.fit.vutbr.cz>
+ */
+
+#ifndef _ARENA_H
+#define _ARENA_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define ARENA_BLOCK_SIZE 65536 // Default block capacity, bigger allocations get a block of their own size
+
+/**
+ * @struct Block of an arena
+ */
+typedef struct arena_block
+{
+    struct arena_block *next; // Older block
+    size_t used; // Used bytes
+    size_t size; // Capacity of data
+    union
+    {
+        long l;
+        double d;
+        void *p;
+    } data[]; // Aligned for every object the parser stores
+} arena_block;
+
+/**
+ * @struct Arena
+ */
+typedef struct
+{
+    arena_block *head; // Block the allocations are currently taken from
+} arena;
+
+/**
+ * @brief Initializes an empty arena
+ * @param a Pointer to the arena structure
+ */
+void arena_init(arena *a);
+
+/**
+ * @brief Allocates size bytes from the arena
+ * @param a Pointer to the arena structure
+ * @param size Number of bytes
+ * @return Pointer to the suitably aligned memory, NULL if the allocation failed
+ */
+void *arena_alloc(arena *a, size_t size);
+
+/**
+ * @brief Allocates size bytes in a block of exactly that size
+ *
+ * For objects kept long after the arena stops growing, the block has no unused capacity.
+ * @param a Pointer to the arena structure
+ * @param size Number of bytes
+ * @return Pointer to the suitably aligned memory, NULL if the allocation failed
+ */
+void *arena_alloc_exact(arena *a, size_t size);
+
+/**
+ * @brief Copies len bytes of s into the arena and terminates them with '\0'
+ * @param a Pointer to the arena structure
+ * @param s Copied characters
+ * @param len Number of copied characters
+ * @return Pointer to the copy, NULL if the allocation failed
+ */
+char *arena_strndup(arena *a, const char *s, size_t len);
+
+/**
+ * @brief Releases all objects of the arena, the newest block is kept for reuse
+ */
+void arena_reset(arena *a);
+
+/**
+ * @brief Frees all blocks of the arena
+ */
+void arena_free(arena *a);
+
+#endif
@@ -0,0 +1,93 @@
+/**
+ * Project name: Imperative language IFJ20 compiler implementation
+ * Název projektu: Implementace překladače imperativního jazyka IFJ20
+ *
+ * @brief Atom table implementation
+ *
+ * @author Petr Kabelka <xkabel09 at stud.fit.vutbr.cz>
+ */
+
+#include "atom.h"
+
+/**
+ * Open addressing table of atom pointers with linear probing
+ */
+static struct
+{
+    atom **slots;
+    unsigned int size;
+    unsigned int count;
+} atoms;
+
+static bool atom_table_grow()
+{
+    unsigned int size = atoms.size == 0 ? ATOM_TABLE_INIT_SIZE : atoms.size * 2;
+    atom **slots = calloc(size, sizeof(atom*));
+    if (slots == NULL)
+    {
+        return false;
+    }
+
+    for (unsigned int i = 0; i < atoms.size; i++)
+    {
+        if (atoms.slots[i] != NULL)
+        {
+            unsigned int idx = atoms.slots[i]->hash & (size - 1);
+            while (slots[idx] != NULL)
+            {
+                idx = (idx + 1) & (size - 1);
+            }
+            slots[idx] = atoms.slots[i];
+        }
+    }
+    free(atoms.slots);
+    atoms.slots = slots;
+    atoms.size = size;
+    return true;
+}
+
+const atom *atom_intern(const char *str, unsigned int len)
+{
+    // keep the load factor under 1/2
+    if ((atoms.count + 1) * 2 > atoms.size && !atom_table_grow())
+    {
+        return NULL;
+    }
+
+    unsigned int hash = str_hash(str, len);
+    unsigned int idx = hash & (atoms.size - 1);
+    while (atoms.slots[idx] != NULL)
+    {
+        atom *a = atoms.slots[idx];
+        if (a->hash == hash && a->len == len && memcmp(a->str, str, len) == 0)
+        {
+            return a;
+        }
+        idx = (idx + 1) & (atoms.size - 1);
+    }
+
+    atom *a = malloc(sizeof(atom) + len + 1);
+    if (a == NULL)
+    {
+        return NULL;
+    }
+    a->id = atoms.count++;
+    a->hash = hash;
+    a->len = len;
+    memcpy(a->str, str, len);
+    a->str[len] = '\0';
+    atoms.slots[idx] = a;
+    return a;
+}
+
+void atom_table_free()
+{
+    for (unsigned int i = 0; i < atoms.size; i++)
+    {
+        free(atoms.slots[i]);
+    }
+    free(atoms.slots);
+    atoms.slots = NULL;
+    atoms.size = 0;
+    atoms.count = 0;
+}
@@ -0,0 +1,45 @@
+/**
+ * Project name: Imperative language IFJ20 compiler implementation
+ * Název projektu: Implementace překladače imperativního jazyka IFJ20
+ *
+ * @brief Atom table interface
+ *
+ * Every identifier spelling is stored once in a global table, so two names
+ * are equal exactly when their atoms are the same.
+ *
+ * @author Petr Kabelka <xkabel09 at stud.fit.vutbr.cz>
+ */
+
+#ifndef _ATOM_H
+#define _ATOM_H
+
+#include <stdbool.h>
+#include "str.h"
+
+#define ATOM_TABLE_INIT_SIZE 256 // Initial number of slots, always a power of two
+
+/**
+ * @struct Interned identifier
+ */
+typedef struct atom
+{
+    unsigned int id; // Order of interning, unique for every atom
+    unsigned int hash; // str_hash of the name
+    unsigned int len; // Name length
+    char str[]; // Null terminated name
+} atom;
+
+/**
+ * @brief Returns the atom of the first len characters of str, creating it if needed
+ * @param str Interned characters, need not be null terminated
+ * @param len Number of interned characters
+ * @return Pointer to the atom, valid until atom_table_free, or NULL upon allocation failure
+ */
+const atom *atom_intern(const char *str, unsigned int len);
+
+/**
+ * @brief Frees all atoms
+ */
+void atom_table_free();
+
+#endif
@@ -8,28 +8,34 @@
  * @author Kryštof Glos <xglosk01 at stud.fit.vutbr.cz>
  */
 
+#define _POSIX_C_SOURCE 200809L // fileno
+#include <unistd.h>
 #include "codegen.h"
+#include "peephole.h"
 
-string ifjcode20_output;
-string for_assigns;
-string func_declarations;
-string func_body;
+rope ifjcode20_output;
+ir_list ifjcode20_code;
+ir_list for_assigns;
+ir_list func_declarations;
+ir_list func_body;
+arena code_text;
 
 bool gen_output_header()
 {
     CODE(".IFJcode20\n"\
-"DEFVAR GF@%%res\n"\
-"MOVE GF@%%res int@0\n"\
-"DEFVAR GF@%%tmp0\n"\
-"MOVE GF@%%tmp0 bool@false\n"\
-"DEFVAR GF@%%tmp1\n"\
-"MOVE GF@%%tmp1 int@0\n"\
-"DEFVAR GF@%%tmp2\n"\
-"MOVE GF@%%tmp2 int@0\n"\
-"DEFVAR GF@%%void\n"\
-"MOVE GF@%%void int@0\n"\
-"JUMP $main\n");
-    GEN_BOOL(gen_builtin_functions);
+"DEFVAR GF@%tmp0\n"\
+"MOVE GF@%tmp0 bool@false\n"\
+"DEFVAR GF@%tmp1\n"\
+"MOVE GF@%tmp1 int@0\n"\
+"DEFVAR GF@%tmp2\n"\
+"MOVE GF@%tmp2 int@0\n"\
+"DEFVAR GF@%void\n"\
+"MOVE GF@%void int@0\n");
+    for (long i = 0; i < PEEPHOLE_REGS; i++)
+    {
+        CODE("DEFVAR GF@%reg"); CODE_NUM(i); CODE("\n");
+    }
+    CODE("JUMP $main\n");
     return true;
     }
 
@@ -41,47 +47,109 @@ bool gen_output_eof()
 
 bool gen_codegen_init()
 {
-    GEN_BOOL(str_init, &ifjcode20_output);
+    GEN_BOOL(rope_init, &ifjcode20_output);
+    ir_init(&ifjcode20_code);
+    ir_init(&for_assigns);
+    ir_init(&func_declarations);
+    ir_init(&func_body);
+    arena_init(&code_text);
     GEN_BOOL(gen_output_header);
     return true;
 }
 
+static FILE *spool = NULL; // finished functions, copied to stdout once the whole source compiled
+
+void gen_codegen_free()
+{
+    rope_free(&ifjcode20_output);
+    ir_free(&ifjcode20_code);
+    ir_free(&for_assigns);
+    ir_free(&func_declarations);
+    ir_free(&func_body);
+    arena_free(&code_text);
+    if (spool != NULL)
+        fclose(spool);
+    spool = NULL;
+}
+
+bool gen_codegen_flush()
+{
+    if(spool==NULL&&(spool=tmpfile())==NULL)return false;
+    if(rope_write(&ifjcode20_output, fileno(spool))!=true)return false;
+    rope_clear(&ifjcode20_output);
+    return true;
+}
+
+bool gen_func_flush(ir_list *code, arena *text)
+{
+    GEN_BOOL(peephole, &func_body);
+    GEN_BOOL(ir_append, &ifjcode20_code, &func_declarations); // header, declarations, body
+    GEN_BOOL(ir_append, &ifjcode20_code, &func_body);
+    GEN_BOOL(ir_copy, code, &ifjcode20_code, text); // kept until all functions are known
+    ir_clear(&ifjcode20_code);
+    arena_reset(&code_text); // no instruction refers to the operands any more
+    return true;
+}
+
+bool gen_func_output(ir_list *code)
+{
+    GEN_BOOL(ir_write, code, &ifjcode20_output);
+    GEN_BOOL(gen_codegen_flush);
+    return true;
+}
+
 bool gen_codegen_output()
 {
     GEN_BOOL(gen_output_eof);
-    if(fprintf(stdout, ifjcode20_output.str)<0)return false;
+    GEN_BOOL(gen_codegen_flush);
     if(fflush(stdout)!=0)return false;
-    return true;
+
+    int fd = fileno(spool);
+    if (lseek(fd, 0, SEEK_SET) != 0)
+        return false;
+    char buffer[65536];
+    ssize_t len;
+    while ((len = read(fd, buffer, sizeof(buffer))) > 0)
+    {
+        for (ssize_t done = 0, n; done < len; done += n)
+        {
+            if ((n = write(STDOUT_FILENO, buffer + done, len - done)) < 0)
+                return false;
+        }
+    }
+    fclose(spool);
+    spool = NULL;
+    return len == 0;
 }
 
 bool gen_func_begin(const char *id)
 {
     if (strcmp(id, "main") == 0)
     {
-        CODE("\nLABEL $main\n"\
-            "CREATEFRAME\n"\
-            "PUSHFRAME\n");
+        INSTR(IR_LABEL, OP_LABEL("$main"));
+        INSTR(IR_CREATEFRAME);
+        INSTR(IR_PUSHFRAME);
         return true;
     }
 
-    CODE("\nLABEL $", id, "\n"\
-        "PUSHFRAME\n");
+    INSTR(IR_LABEL, OP_LABEL("$%s", id));
+    INSTR(IR_PUSHFRAME);
     return true;
 }
 
 bool gen_func_def_retval(unsigned long idx, keyword kw)
 {
-    CODE("DEFVAR LF@%%retval"); CODE_NUM(idx); CODE("\n");
+    INSTR(IR_DEFVAR, OP_VAR("LF@%%retval%lu", idx));
     switch (kw)
     {
     case KW_INT:
-        CODE("MOVE LF@%%retval"); CODE_NUM(idx); CODE(" int@0\n");
+        INSTR(IR_MOVE, OP_VAR("LF@%%retval%lu", idx), OP_CONST("int@0"));
         break;
     case KW_FLOAT64:
-        CODE("MOVE LF@%%retval"); CODE_NUM(idx); CODE(" float@0x0p+0\n");
+        INSTR(IR_MOVE, OP_VAR("LF@%%retval%lu", idx), OP_CONST("float@0x0p+0"));
         break;
     case KW_STRING:
-        CODE("MOVE LF@%%retval"); CODE_NUM(idx); CODE(" string@\n");
+        INSTR(IR_MOVE, OP_VAR("LF@%%retval%lu", idx), OP_CONST("string@"));
         break;
     default:
         break;
@@ -91,68 +159,77 @@ bool gen_func_def_retval(unsigned long idx, keyword kw)
 
 bool gen_func_set_retval(unsigned long idx)
 {
-    CODE("POPS LF@%%retval"); CODE_NUM(idx); CODE("\n");
+    INSTR(IR_POPS, OP_VAR("LF@%%retval%lu", idx));
     return true;
 }
 
 bool gen_defvar(char *id)
 {
-    CODE("DEFVAR LF@", id, "\n");
+    INSTR(IR_DEFVAR, OP_VAR("LF@%s", id));
     return true;
 }
 
-bool gen_defvar_str(char *id, unsigned long idx, string *s)
+bool gen_defvar_str(const char *id, unsigned long idx, ir_list *l)
 {
-    str_swap(&ifjcode20_output, s);
-    CODE("DEFVAR LF@", id, "%%"); CODE_NUM(idx); CODE("\n"); // DEFVAR LF@id%idx
-    str_swap(&ifjcode20_output, s);
+    GEN_BOOL(ir_emit, l, IR_DEFVAR, OP_VAR("LF@%s%%%lu", id, idx)); // DEFVAR LF@id%idx
     return true;
 }
 
 bool gen_pop(char *id, char *frame)
 {
-    CODE("POPS ", frame, "@", id, "\n");
+    INSTR(IR_POPS, OP_VAR("%s@%s", frame, id));
     return true;
 }
 
-bool gen_pop_idx(char *id, char *frame, unsigned long idx)
+bool gen_pop_idx(const char *id, char *frame, unsigned long idx)
 {
-    CODE("POPS ", frame, "@", id, "%%"); CODE_NUM(idx); CODE("\n");
+    INSTR(IR_POPS, OP_VAR("%s@%s%%%lu", frame, id, idx));
     return true;
 }
 
 bool gen_get_retval(char *id, char *frame, unsigned long idx)
 {
-    CODE("MOVE ", frame, "@", id, " TF@%%retval"); CODE_NUM(idx); CODE("\n");
+    INSTR(IR_MOVE, OP_VAR("%s@%s", frame, id), OP_VAR("TF@%%retval%lu", idx));
     return true;
 }
 
-bool gen_func_arg(char *arg_id, unsigned long idx, unsigned long scope_idx)
+bool gen_push_retval(unsigned long idx)
 {
-    CODE("DEFVAR LF@", arg_id); CODE("%%"); CODE_NUM(scope_idx); CODE("\n"); // DEFVAR LF@id
-    CODE("MOVE LF@", arg_id); CODE("%%"); CODE_NUM(scope_idx); CODE(" LF@%%"); CODE_NUM(idx); CODE("\n"); // MOVE LF@id LF@%idx
+    INSTR(IR_PUSHS, OP_VAR("TF@%%retval%lu", idx));
     return true;
 }
 
-bool gen_func_call(const char *id) { CODE("CALL $", id, "\n"); return true; }
+bool gen_func_arg(const char *arg_id, unsigned long idx, unsigned long scope_idx)
+{
+    INSTR(IR_DEFVAR, OP_VAR("LF@%s%%%lu", arg_id, scope_idx)); // DEFVAR LF@id
+    INSTR(IR_MOVE, OP_VAR("LF@%s%%%lu", arg_id, scope_idx), OP_VAR("LF@%%%lu", idx)); // MOVE LF@id LF@%idx
+    return true;
+}
 
-bool gen_token_value(token *tok)
+bool gen_func_call(const char *id)
 {
+    INSTR(IR_CALL, OP_LABEL("$%s", id));
+    return true;
+}
+
+ir_operand gen_token_value(token *tok, unsigned long scope_idx)
+{
+    ir_operand operand = { IR_CONST, NULL };
     string tmp;
-    GEN_BOOL(str_init, &tmp);
-    char str[20*sizeof(char)];
     char c;
 
     switch (tok->type)
     {
         case TOKEN_STRING:
+            if (!str_init(&tmp))
+                return operand;
             for (int i = 0; (c = tok->attr.str->str[i]) != '\0'; i++)
             {
                 if (c == '\\' || isprint(c) == 0 || c == '#' || c <= 32)
                 {
                     // c as ASCII value in \000 format
-                    str_add(&tmp, '\\');
-                    sprintf(str, "%03d", c);
+                    char str[8];
+                    sprintf(str, "\\%03d", c);
                     str_add_const(&tmp, str);
                 }
                 else
@@ -160,286 +237,400 @@ bool gen_token_value(token *tok)
                     str_add(&tmp, c);
                 }
             }
-            CODE("string@"); CODE(tmp.str); // string@text
+            operand = OP_CONST("string@%s", tmp.str); // string@text
+            str_free(&tmp);
             break;
         case TOKEN_IDENTIFIER:
-            CODE("LF@"); CODE(tok->attr.str->str); // LF@id
+            operand = OP_VAR("LF@%s%%%lu", tok->attr.id->str, scope_idx); // LF@id%scope_idx
             break;
         case TOKEN_INT:
-            CODE("int@"); CODE_NUM(tok->attr.int_val); // int@int_val
+            operand = OP_CONST("int@%ld", tok->attr.int_val); // int@int_val
             break;
         case TOKEN_FLOAT64:
-            CODE("float@"); sprintf(str, "%a", tok->attr.float64_val); CODE(str); // float@hex_float
+            operand = OP_CONST("float@%a", tok->attr.float64_val); // float@hex_float
             break;
         default:
-            str_free(&tmp);
-            return false;
+            break;
+    }
+    return operand;
+}
+
+ir_operand gen_var_operand(const char *id, unsigned long scope_idx)
+{
+    if (id == NULL)
+    {
+        return OP_VAR("GF@%%void");
     }
-    str_free(&tmp);
+    return OP_VAR("LF@%s%%%lu", id, scope_idx); // LF@id%scope_idx
+}
+
+bool gen_builtin_inline(keyword kw, const char *id, unsigned long idx, ir_operand *args, unsigned long nargs, ir_operand *dst, unsigned long ndst)
+{
+    unsigned long results = kw == KW_ORD || kw == KW_CHR || kw == KW_SUBSTR ? 2 : 1;
+    if (nargs != (kw == KW_SUBSTR ? 3 : kw == KW_ORD ? 2 : 1) || ndst != results)
+    {
+        return true; // a wrong call is reported by the semantic checks, the code is never written out
+    }
+
+    switch (kw)
+    {
+    case KW_LEN:
+        INSTR(IR_STRLEN, dst[0], args[0]);
+        return true;
+    case KW_INT2FLOAT:
+        INSTR(IR_INT2FLOAT, dst[0], args[0]);
+        return true;
+    case KW_FLOAT2INT:
+        INSTR(IR_FLOAT2INT, dst[0], args[0]);
+        return true;
+    case KW_ORD:
+        // 0 <= i < len(s), the error result is the one of the ord function
+        INSTR(IR_LT, OP_VAR("GF@%%tmp1"), args[1], OP_CONST("int@0"));
+        INSTR(IR_JUMPIFEQ, OP_LABEL("$%s$%lu$err", id, idx), OP_VAR("GF@%%tmp1"), OP_CONST("bool@true"));
+        INSTR(IR_STRLEN, OP_VAR("GF@%%tmp0"), args[0]);
+        INSTR(IR_LT, OP_VAR("GF@%%tmp1"), args[1], OP_VAR("GF@%%tmp0"));
+        INSTR(IR_JUMPIFNEQ, OP_LABEL("$%s$%lu$err", id, idx), OP_VAR("GF@%%tmp1"), OP_CONST("bool@true"));
+        INSTR(IR_STRI2INT, dst[0], args[0], args[1]);
+        INSTR(IR_MOVE, dst[1], OP_CONST("int@0"));
+        INSTR(IR_JUMP, OP_LABEL("$%s$%lu$noerr", id, idx));
+        INSTR(IR_LABEL, OP_LABEL("$%s$%lu$err", id, idx));
+        INSTR(IR_MOVE, dst[0], OP_CONST("int@-2"));
+        INSTR(IR_MOVE, dst[1], OP_CONST("int@1"));
+        INSTR(IR_LABEL, OP_LABEL("$%s$%lu$noerr", id, idx));
+        return true;
+    case KW_CHR:
+        // 0 <= i <= 255
+        INSTR(IR_LT, OP_VAR("GF@%%tmp1"), args[0], OP_CONST("int@0"));
+        INSTR(IR_JUMPIFEQ, OP_LABEL("$%s$%lu$err", id, idx), OP_VAR("GF@%%tmp1"), OP_CONST("bool@true"));
+        INSTR(IR_GT, OP_VAR("GF@%%tmp1"), args[0], OP_CONST("int@255"));
+        INSTR(IR_JUMPIFEQ, OP_LABEL("$%s$%lu$err", id, idx), OP_VAR("GF@%%tmp1"), OP_CONST("bool@true"));
+        INSTR(IR_INT2CHAR, dst[0], args[0]);
+        INSTR(IR_MOVE, dst[1], OP_CONST("int@0"));
+        INSTR(IR_JUMP, OP_LABEL("$%s$%lu$noerr", id, idx));
+        INSTR(IR_LABEL, OP_LABEL("$%s$%lu$err", id, idx));
+        INSTR(IR_MOVE, dst[0], OP_CONST("string@"));
+        INSTR(IR_MOVE, dst[1], OP_CONST("int@1"));
+        INSTR(IR_LABEL, OP_LABEL("$%s$%lu$noerr", id, idx));
+        return true;
+    case KW_SUBSTR:
+        // the body is too long to repeat, only the results are moved in place
+        INSTR(IR_CREATEFRAME);
+        for (unsigned long i = 0; i < nargs; i++)
+        {
+            INSTR(IR_DEFVAR, OP_VAR("TF@%%%lu", i));
+            INSTR(IR_MOVE, OP_VAR("TF@%%%lu", i), args[i]);
+        }
+        INSTR(IR_CALL, OP_LABEL("$substr"));
+        INSTR(IR_MOVE, dst[0], OP_VAR("TF@%%retval0"));
+        INSTR(IR_MOVE, dst[1], OP_VAR("TF@%%retval1"));
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool gen_move(ir_operand dst, ir_operand src)
+{
+    INSTR(IR_MOVE, dst, src);
     return true;
 }
 
 bool gen_func_call_arg(unsigned long idx, token *tok)
 {
-    CODE("DEFVAR TF@%%"); CODE_NUM(idx); CODE("\n"); // DEFVAR TF@idx
-    CODE("MOVE TF@%%"); CODE_NUM(idx); CODE(" "); GEN(gen_token_value, tok); CODE("\n"); // MOVE TF@idx type@value
+    INSTR(IR_DEFVAR, OP_VAR("TF@%%%lu", idx)); // DEFVAR TF@idx
+    INSTR(IR_MOVE, OP_VAR("TF@%%%lu", idx), gen_token_value(tok, 0)); // MOVE TF@idx type@value
     return true;
 }
 
 bool gen_func_call_arg_idx(unsigned long idx, token *tok, unsigned long scope_idx)
 {
-    CODE("DEFVAR TF@%%"); CODE_NUM(idx); CODE("\n"); // DEFVAR TF@idx
-    CODE("MOVE TF@%%"); CODE_NUM(idx); CODE(" "); GEN(gen_token_value, tok); // MOVE TF@idx type@value
-    if (tok->type == TOKEN_IDENTIFIER)
-    {
-        CODE("%%"); CODE_NUM(scope_idx);
-    }
-    CODE("\n");
+    INSTR(IR_DEFVAR, OP_VAR("TF@%%%lu", idx)); // DEFVAR TF@idx
+    INSTR(IR_MOVE, OP_VAR("TF@%%%lu", idx), gen_token_value(tok, scope_idx)); // MOVE TF@idx type@value
     return true;
 }
 
-bool gen_func_arg_push(token *tok, unsigned long idx)
+bool gen_write(token *tok, unsigned long scope_idx)
 {
-    CODE("PUSHS "); GEN(gen_token_value, tok); // PUSHS type@value
-    if (tok->type == TOKEN_IDENTIFIER)
+    INSTR(IR_WRITE, gen_token_value(tok, scope_idx)); // WRITE type@value
+    return true;
+}
+
+bool gen_func_return(const char *id)
+{
+    if (strcmp(id, "main") == 0)
     {
-        CODE("%%"); CODE_NUM(idx);
+        INSTR(IR_JUMP, OP_LABEL("$$EOF")); // main has no return label, the data stack is empty between statements
+        return true;
     }
-    CODE("\n");
+
+    INSTR(IR_JUMP, OP_LABEL("$%s$return", id));
     return true;
 }
 
-bool gen_func_return(const char *id) { CODE("JUMP $", id, "$return\n"); return true; }
-
 bool gen_func_end(const char *id)
 {
     if (strcmp(id, "main") == 0)
     {
-        CODE("CLEARS\n"\
-            "JUMP $$EOF\n");
+        INSTR(IR_CLEARS);
+        INSTR(IR_JUMP, OP_LABEL("$$EOF"));
         return true;
     }
 
-    CODE("LABEL $", id, "$return\n", // LABEL $id$return
-        "POPFRAME\n"\
-        "RETURN\n");
+    INSTR(IR_LABEL, OP_LABEL("$%s$return", id)); // LABEL $id$return
+    INSTR(IR_POPFRAME);
+    INSTR(IR_RETURN);
     return true;
 }
 
-bool gen_create_frame() { CODE("CREATEFRAME\n"); return true; }
+bool gen_create_frame()
+{
+    INSTR(IR_CREATEFRAME);
+    return true;
+}
 
 bool gen_label(const char *id, unsigned long idx, unsigned long depth)
 {
-    CODE("LABEL $", id, "$"); CODE_NUM(idx); CODE("$"); CODE_NUM(depth); CODE("\n"); // LABEL $id$idx$depth
+    INSTR(IR_LABEL, OP_LABEL("$%s$%lu$%lu", id, idx, depth)); // LABEL $id$idx$depth
     return true;
 }
 
-bool gen_if_start(const char *id, unsigned long idx)
+bool gen_if_start(const char *id, unsigned long idx, bool holds_eq)
 {
-    CODE("JUMPIFNEQ $", id, "$"); CODE_NUM(idx); CODE("$else GF@%%res bool@true\n"); // JUMPIFNEQ $id$idx$else GF@%%res bool@true
+    // JUMPIFNEQS $id$idx$else when the condition holds for equal values
+    INSTR(holds_eq ? IR_JUMPIFNEQS : IR_JUMPIFEQS, OP_LABEL("$%s$%lu$else", id, idx));
     return true;
 }
 
 bool gen_else(const char *id, unsigned long idx)
 {
-    CODE("JUMP $", id, "$"); CODE_NUM(idx); CODE("$endif\n"); // JUMP $id$endif
-    CODE("LABEL $", id, "$"); CODE_NUM(idx); CODE("$else"); CODE("\n"); // LABEL $id$else
+    INSTR(IR_JUMP, OP_LABEL("$%s$%lu$endif", id, idx)); // JUMP $id$endif
+    INSTR(IR_LABEL, OP_LABEL("$%s$%lu$else", id, idx)); // LABEL $id$else
     return true;
 }
 
 bool gen_endif(const char *id, unsigned long idx)
 {
-    CODE("LABEL $", id, "$"); CODE_NUM(idx); CODE("$endif"); CODE("\n"); // LABEL $id$endif
+    INSTR(IR_LABEL, OP_LABEL("$%s$%lu$endif", id, idx)); // LABEL $id$endif
     return true;
 }
 
 bool gen_for_start(const char *id, unsigned long idx)
 {
-    CODE("LABEL $", id, "$"); CODE_NUM(idx); CODE("$for"); CODE("\n"); // LABEL $id$for
+    INSTR(IR_LABEL, OP_LABEL("$%s$%lu$for", id, idx)); // LABEL $id$for
     return true;
 }
 
-bool gen_for_cond(const char *id, unsigned long idx)
+bool gen_for_cond(const char *id, unsigned long idx, bool holds_eq)
 {
-    CODE("JUMPIFNEQ $", id, "$"); CODE_NUM(idx); CODE("$endfor GF@%%res bool@true\n"); // JUMPIFNEQ $id$idx$endfor GF@%%res bool@true
+    // JUMPIFNEQS $id$idx$endfor when the condition holds for equal values
+    INSTR(holds_eq ? IR_JUMPIFNEQS : IR_JUMPIFEQS, OP_LABEL("$%s$%lu$endfor", id, idx));
     return true;
 }
 
 bool gen_endfor(const char *id, unsigned long idx)
 {
-    CODE("JUMP $", id, "$"); CODE_NUM(idx); CODE("$for"); CODE("\n"); // JUMP $id$idx$for
-    CODE("LABEL $", id, "$"); CODE_NUM(idx); CODE("$endfor"); CODE("\n"); // LABEL $id$idx$endfor
+    INSTR(IR_JUMP, OP_LABEL("$%s$%lu$for", id, idx)); // JUMP $id$idx$for
+    INSTR(IR_LABEL, OP_LABEL("$%s$%lu$endfor", id, idx)); // LABEL $id$idx$endfor
     return true;
 }
 
-bool gen_builtin_functions()
+static const struct
 {
-    CODE("###################################################\n"\
+    const char *id;
+    const char *code;
+} builtins[] = {
+    { "len",
 "LABEL $len\n"\
 "PUSHFRAME\n"\
-"DEFVAR LF@%%retval0\n"\
-"STRLEN LF@%%retval0 LF@%%0\n"\
+"DEFVAR LF@%retval0\n"\
+"STRLEN LF@%retval0 LF@%0\n"\
 "POPFRAME\n"\
-"RETURN\n"\
-"###################################################\n"\
+"RETURN\n" },
+    { "inputs",
 "LABEL $inputs\n"\
 "PUSHFRAME\n"\
-"DEFVAR LF@%%retval0\n"\
-"DEFVAR LF@%%retval1\n"\
-"MOVE LF@%%retval1 int@0\n"\
-"READ LF@%%retval0 string\n"\
-"JUMPIFNEQ $inputs$noerr LF@%%retval0 nil@nil\n"\
-"MOVE LF@%%retval1 int@1\n"\
+"DEFVAR LF@%retval0\n"\
+"DEFVAR LF@%retval1\n"\
+"MOVE LF@%retval1 int@0\n"\
+"READ LF@%retval0 string\n"\
+"JUMPIFNEQ $inputs$noerr LF@%retval0 nil@nil\n"\
+"MOVE LF@%retval1 int@1\n"\
 "LABEL $inputs$noerr\n"\
 "POPFRAME\n"\
-"RETURN\n"\
-"###################################################\n"\
+"RETURN\n" },
+    { "inputi",
 "LABEL $inputi\n"\
 "PUSHFRAME\n"\
-"DEFVAR LF@%%retval0\n"\
-"DEFVAR LF@%%retval1\n"\
-"MOVE LF@%%retval1 int@0\n"\
+"DEFVAR LF@%retval0\n"\
+"DEFVAR LF@%retval1\n"\
+"MOVE LF@%retval1 int@0\n"\
 "DEFVAR LF@typeout\n"\
-"READ LF@%%retval0 int\n"\
-"TYPE LF@typeout LF@%%retval0\n"\
+"READ LF@%retval0 int\n"\
+"TYPE LF@typeout LF@%retval0\n"\
 "JUMPIFEQ $inputi$istrue LF@typeout string@int\n"\
-"MOVE LF@%%retval0 int@1\n"\
-"MOVE LF@%%retval1 int@1\n"\
+"MOVE LF@%retval0 int@1\n"\
+"MOVE LF@%retval1 int@1\n"\
 "POPFRAME\n"\
 "RETURN\n"\
 "LABEL $inputi$istrue\n"\
 "POPFRAME\n"\
-"RETURN\n"\
-"###################################################\n"\
+"RETURN\n" },
+    { "inputf",
 "LABEL $inputf\n"\
 "PUSHFRAME\n"\
-"DEFVAR LF@%%retval0\n"\
-"DEFVAR LF@%%retval1\n"\
-"MOVE LF@%%retval1 int@0\n"\
+"DEFVAR LF@%retval0\n"\
+"DEFVAR LF@%retval1\n"\
+"MOVE LF@%retval1 int@0\n"\
 "DEFVAR LF@typeout\n"\
-"READ LF@%%retval0 float\n"\
-"TYPE LF@typeout LF@%%retval0\n"\
+"READ LF@%retval0 float\n"\
+"TYPE LF@typeout LF@%retval0\n"\
 "JUMPIFEQ $inputf$istrue LF@typeout string@float\n"\
-"MOVE LF@%%retval0 float@0x1p+0\n"\
-"MOVE LF@%%retval1 int@1\n"\
+"MOVE LF@%retval0 float@0x1p+0\n"\
+"MOVE LF@%retval1 int@1\n"\
 "POPFRAME\n"\
 "RETURN\n"\
 "LABEL $inputf$istrue\n"\
 "POPFRAME\n"\
-"RETURN\n"\
-"###################################################\n"\
-"LABEL $print\n"\
-"PUSHFRAME\n"\
-"DEFVAR LF@%%0\n"\
-"POPS LF@%%0\n"\
-"DEFVAR LF@tmp\n"\
-"DEFVAR LF@index\n"\
-"MOVE LF@index int@0\n"\
-"LABEL $print$while\n"\
-"JUMPIFEQ $print$return LF@index LF@%%0\n"\
-"POPS LF@tmp\n"\
-"WRITE LF@tmp\n"\
-"ADD LF@index LF@index int@1\n"\
-"JUMP $print$while\n"\
-"LABEL $print$return\n"\
-"POPFRAME\n"\
-"RETURN\n"\
-"###################################################\n"\
+"RETURN\n" },
+    { "int2float",
 "LABEL $int2float\n"\
 "PUSHFRAME\n"\
-"DEFVAR LF@%%retval0\n"\
-"INT2FLOAT LF@%%retval0 LF@%%0\n"\
+"DEFVAR LF@%retval0\n"\
+"INT2FLOAT LF@%retval0 LF@%0\n"\
 "POPFRAME\n"\
-"RETURN\n"\
-"###################################################\n"\
+"RETURN\n" },
+    { "float2int",
 "LABEL $float2int\n"\
 "PUSHFRAME\n"\
-"DEFVAR LF@%%retval0\n"\
-"FLOAT2INT LF@%%retval0 LF@%%0\n"\
+"DEFVAR LF@%retval0\n"\
+"FLOAT2INT LF@%retval0 LF@%0\n"\
 "POPFRAME\n"\
-"RETURN\n"\
-"###################################################\n"\
+"RETURN\n" },
+    { "substr",
 "LABEL $substr\n"\
 "PUSHFRAME\n"\
-"DEFVAR LF@%%retval1\n"\
-"MOVE LF@%%retval1 int@0\n"\
-"DEFVAR LF@index\n"\
-"MOVE LF@index int@1\n"\
+"DEFVAR LF@%retval0\n"\
+"MOVE LF@%retval0 string@\n"\
+"DEFVAR LF@%retval1\n"\
+"MOVE LF@%retval1 int@1\n"\
+"DEFVAR LF@rest\n"\
+"STRLEN LF@rest LF@%0\n"\
 "DEFVAR LF@tmp\n"\
-"DEFVAR LF@%%retval0\n"\
-"MOVE LF@%%retval0 string@\n"\
-"\n"\
-"STRLEN LF@tmp LF@%%0\n"\
-"LT LF@%%retval1 LF@%%1 int@0\n"\
-"JUMPIFEQ $substr$error LF@%%retval1 bool@true\n"\
-"GT LF@%%retval1 LF@%%1 LF@tmp\n"\
-"JUMPIFEQ $substr$error LF@%%retval1 bool@true\n"\
-"LT LF@%%retval1 LF@%%2 int@0\n"\
-"JUMPIFEQ $substr$error LF@%%retval1 bool@true\n"\
-"SUB LF@tmp LF@tmp LF@%%1\n"\
-"GT LF@%%retval1 LF@%%2 LF@tmp\n"\
-"JUMPIFEQ $substr$isgreater LF@%%retval1 bool@true\n"\
-"LABEL $substr$continue\n"\
-"JUMPIFEQ $substr$end LF@%%2 int@0\n"\
-"GETCHAR LF@%%retval0 LF@%%0 LF@%%1\n"\
-"JUMPIFEQ $substr$end LF@%%2 int@1\n"\
-"\n"\
-"LABEL $substr$cycle\n"\
-"ADD LF@%%1 LF@%%1 int@1\n"\
-"ADD LF@index LF@index int@1\n"\
-"GETCHAR LF@tmp LF@%%0 LF@%%1\n"\
-"CONCAT LF@%%retval0 LF@%%retval0 LF@tmp\n"\
-"JUMPIFNEQ $substr$cycle LF@index LF@%%2\n"\
-"LABEL $substr$end\n"\
-"MOVE LF@%%retval1 int@0\n"\
+"LT LF@tmp LF@%1 int@0\n"\
+"JUMPIFEQ $substr$return LF@tmp bool@true\n"\
+"GT LF@tmp LF@%1 LF@rest\n"\
+"JUMPIFEQ $substr$return LF@tmp bool@true\n"\
+"LT LF@tmp LF@%2 int@0\n"\
+"JUMPIFEQ $substr$return LF@tmp bool@true\n"\
+"MOVE LF@%retval1 int@0\n"\
+"SUB LF@rest LF@rest LF@%1\n"\
+"LT LF@tmp LF@%2 LF@rest\n"\
+"JUMPIFEQ $substr$short LF@tmp bool@true\n"\
+"JUMPIFEQ $substr$whole LF@%1 int@0\n"\
+"MOVE LF@%2 LF@rest\n"\
+"LABEL $substr$short\n"\
+"JUMPIFEQ $substr$return LF@%2 int@0\n"\
+"GETCHAR LF@%retval0 LF@%0 LF@%1\n"\
+"JUMPIFEQ $substr$return LF@%2 int@1\n"\
+"DEFVAR LF@end\n"\
+"ADD LF@end LF@%1 LF@%2\n"\
+"ADD LF@%1 LF@%1 int@1\n"\
+"DEFVAR LF@chunk\n"\
+"DEFVAR LF@chunkend\n"\
+"SUB LF@chunkend LF@%2 int@1\n"\
+"IDIV LF@chunkend LF@chunkend int@8\n"\
+"MUL LF@chunkend LF@chunkend int@8\n"\
+"ADD LF@chunkend LF@chunkend LF@%1\n"\
+"JUMPIFEQ $substr$rest LF@%1 LF@chunkend\n"\
+"LABEL $substr$chunk\n"\
+"GETCHAR LF@chunk LF@%0 LF@%1\n"\
+"ADD LF@%1 LF@%1 int@1\n"\
+"GETCHAR LF@tmp LF@%0 LF@%1\n"\
+"ADD LF@%1 LF@%1 int@1\n"\
+"CONCAT LF@chunk LF@chunk LF@tmp\n"\
+"GETCHAR LF@tmp LF@%0 LF@%1\n"\
+"ADD LF@%1 LF@%1 int@1\n"\
+"CONCAT LF@chunk LF@chunk LF@tmp\n"\
+"GETCHAR LF@tmp LF@%0 LF@%1\n"\
+"ADD LF@%1 LF@%1 int@1\n"\
+"CONCAT LF@chunk LF@chunk LF@tmp\n"\
+"GETCHAR LF@tmp LF@%0 LF@%1\n"\
+"ADD LF@%1 LF@%1 int@1\n"\
+"CONCAT LF@chunk LF@chunk LF@tmp\n"\
+"GETCHAR LF@tmp LF@%0 LF@%1\n"\
+"ADD LF@%1 LF@%1 int@1\n"\
+"CONCAT LF@chunk LF@chunk LF@tmp\n"\
+"GETCHAR LF@tmp LF@%0 LF@%1\n"\
+"ADD LF@%1 LF@%1 int@1\n"\
+"CONCAT LF@chunk LF@chunk LF@tmp\n"\
+"GETCHAR LF@tmp LF@%0 LF@%1\n"\
+"ADD LF@%1 LF@%1 int@1\n"\
+"CONCAT LF@chunk LF@chunk LF@tmp\n"\
+"CONCAT LF@%retval0 LF@%retval0 LF@chunk\n"\
+"JUMPIFNEQ $substr$chunk LF@%1 LF@chunkend\n"\
+"LABEL $substr$rest\n"\
+"JUMPIFEQ $substr$return LF@%1 LF@end\n"\
+"LABEL $substr$char\n"\
+"GETCHAR LF@tmp LF@%0 LF@%1\n"\
+"CONCAT LF@%retval0 LF@%retval0 LF@tmp\n"\
+"ADD LF@%1 LF@%1 int@1\n"\
+"JUMPIFNEQ $substr$char LF@%1 LF@end\n"\
+"LABEL $substr$return\n"\
 "POPFRAME\n"\
 "RETURN\n"\
-"LABEL $substr$error\n"\
-"MOVE LF@%%retval1 int@1\n"\
+"LABEL $substr$whole\n"\
+"MOVE LF@%retval0 LF@%0\n"\
 "POPFRAME\n"\
-"RETURN\n"\
-"\n"\
-"LABEL $substr$isgreater\n"\
-"MOVE LF@%%2 LF@tmp\n"\
-"JUMP $substr$continue\n"\
-"###################################################\n"\
+"RETURN\n" },
+    { "ord",
 "LABEL $ord\n"\
 "PUSHFRAME\n"\
-"DEFVAR LF@%%retval1\n"\
-"DEFVAR LF@%%retval0 \n"\
-"STRLEN LF@%%retval0 LF@%%0\n"\
-"SUB LF@%%retval0 LF@%%retval0 int@1\n"\
-"GT LF@%%retval1 LF@%%1 LF@%%retval0\n"\
-"JUMPIFEQ $ord$error LF@%%retval1 bool@true\n"\
-"LT LF@%%retval1 LF@%%1 int@0\n"\
-"JUMPIFEQ $ord$error LF@%%retval1 bool@true\n"\
-"STRI2INT LF@%%retval0 LF@%%0 LF@%%1\n"\
-"MOVE LF@%%retval1 int@0\n"\
+"DEFVAR LF@%retval1\n"\
+"DEFVAR LF@%retval0 \n"\
+"STRLEN LF@%retval0 LF@%0\n"\
+"SUB LF@%retval0 LF@%retval0 int@1\n"\
+"GT LF@%retval1 LF@%1 LF@%retval0\n"\
+"JUMPIFEQ $ord$error LF@%retval1 bool@true\n"\
+"LT LF@%retval1 LF@%1 int@0\n"\
+"JUMPIFEQ $ord$error LF@%retval1 bool@true\n"\
+"STRI2INT LF@%retval0 LF@%0 LF@%1\n"\
+"MOVE LF@%retval1 int@0\n"\
 "POPFRAME\n"\
 "RETURN\n"\
 "LABEL $ord$error\n"\
-"MOVE LF@%%retval0 int@-2\n"\
-"MOVE LF@%%retval1 int@1\n"\
+"MOVE LF@%retval0 int@-2\n"\
+"MOVE LF@%retval1 int@1\n"\
 "POPFRAME\n"\
-"RETURN\n"\
-"###################################################\n"\
+"RETURN\n" },
+    { "chr",
 "LABEL $chr\n"\
 "PUSHFRAME\n"\
-"DEFVAR LF@%%retval1\n"\
-"DEFVAR LF@%%retval0\n"\
-"GT LF@%%retval1 LF@%%0 int@255\n"\
-"JUMPIFEQ $chr$error LF@%%retval1 bool@true\n"\
-"LT LF@%%retval1 LF@%%0 int@0\n"\
-"JUMPIFEQ $chr$error LF@%%retval1 bool@true\n"\
-"INT2CHAR LF@%%retval0 LF@%%0\n"\
-"MOVE LF@%%retval1 int@0\n"\
+"DEFVAR LF@%retval1\n"\
+"DEFVAR LF@%retval0\n"\
+"GT LF@%retval1 LF@%0 int@255\n"\
+"JUMPIFEQ $chr$error LF@%retval1 bool@true\n"\
+"LT LF@%retval1 LF@%0 int@0\n"\
+"JUMPIFEQ $chr$error LF@%retval1 bool@true\n"\
+"INT2CHAR LF@%retval0 LF@%0\n"\
+"MOVE LF@%retval1 int@0\n"\
 "POPFRAME\n"\
 "RETURN\n"\
 "LABEL $chr$error\n"\
-"MOVE LF@%%retval0 string@\n"\
-"MOVE LF@%%retval1 int@1\n"\
+"MOVE LF@%retval0 string@\n"\
+"MOVE LF@%retval1 int@1\n"\
 "POPFRAME\n"\
-"RETURN\n"\
-"###################################################\n");
-    return true;
+"RETURN\n" }
+};
+
+bool gen_builtin_function(const char *id)
+{
+    for (size_t i = 0; i < sizeof(builtins) / sizeof(builtins[0]); i++)
+    {
+        if (strcmp(builtins[i].id, id) == 0)
+        {
+            CODE("###################################################\n", builtins[i].code);
+            return true;
+        }
+    }
+    return false;
 }
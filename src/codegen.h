@@ -14,6 +14,8 @@
 #include <string.h>
 #include <ctype.h>
 #include "str.h"
+#include "rope.h"
+#include "ir.h"
 #include "stdbool.h"
 #include "error.h"
 #include "scanner.h"
@@ -22,19 +24,32 @@
  * @brief Adds string to the output code string
  * @return false if there was an error
  */
-#define CODE(...) if(str_add_var(&ifjcode20_output, __VA_ARGS__, NULL)!=true)return false
+#define CODE(...) if(rope_add_var(&ifjcode20_output, __VA_ARGS__, NULL)!=true)return false
 
 /**
- * @brief Adds string to the output code string
- * @return ERR_INTERNAL if there was an error
+ * @brief Adds int to the output code string
+ * @return false if there was an error
  */
-#define CODE_INT(...) if(str_add_var(&ifjcode20_output, __VA_ARGS__, NULL)!=true)return ERR_INTERNAL
+#define CODE_NUM(_VAL) do{char str[32*sizeof(char)]; sprintf(str, "%ld", _VAL); CODE(str);}while(0)
 
 /**
- * @brief Adds int to the output code string
+ * @brief Appends an instruction to the code of the generated function
  * @return false if there was an error
  */
-#define CODE_NUM(_VAL) do{char str[20*sizeof(char)]; sprintf(str, "%ld", _VAL); CODE(str);}while(0)
+#define INSTR(...) if(ir_emit(&ifjcode20_code, __VA_ARGS__)!=true)return false
+
+/**
+ * @brief Appends an instruction to the code of the generated function
+ * @return ERR_INTERNAL if there was an error
+ */
+#define INSTR_INT(...) if(ir_emit(&ifjcode20_code, __VA_ARGS__)!=true)return ERR_INTERNAL
+
+/**
+ * @brief Operands from printf-like formats, valid until the function is written out
+ */
+#define OP_VAR(...) ir_operand_fmt(&code_text, IR_VAR, __VA_ARGS__)
+#define OP_CONST(...) ir_operand_fmt(&code_text, IR_CONST, __VA_ARGS__)
+#define OP_LABEL(...) ir_operand_fmt(&code_text, IR_LABEL_REF, __VA_ARGS__)
 
 /**
  * @brief Calls _FUNC with arguments passed
@@ -48,13 +63,40 @@
  */
 #define GEN_BOOL(_FUNC, ...) if(_FUNC(__VA_ARGS__)==false)return false
 
-extern string ifjcode20_output;
-extern string for_assigns;
-extern string func_declarations;
-extern string func_body;
+extern rope ifjcode20_output; // text of the header and of the finished functions
+extern ir_list ifjcode20_code; // code of the function being generated
+extern ir_list for_assigns;
+extern ir_list func_declarations;
+extern ir_list func_body;
+extern arena code_text; // operand texts of the function being generated
 
 bool gen_codegen_init();
+void gen_codegen_free();
 bool gen_codegen_output();
+
+/**
+ * @brief Moves the code generated so far to a temporary file and clears the output
+ *
+ * gen_codegen_output copies the file to stdout, so nothing is written there when
+ * an error is found later in the source.
+ * @return false if there was an error
+ */
+bool gen_codegen_flush();
+
+/**
+ * @brief Optimizes func_body and copies the function into code, after its header and func_declarations
+ *
+ * The copy has no unused capacity and its operand texts are in one block of text.
+ * @param text Arena the operand texts are copied to
+ * @return false if there was an error
+ */
+bool gen_func_flush(ir_list *code, arena *text);
+
+/**
+ * @brief Writes the function code out of memory as text
+ * @return false if there was an error
+ */
+bool gen_func_output(ir_list *code);
 bool gen_output_header();
 bool gen_output_eof();
 bool gen_main_begin();
@@ -64,26 +106,61 @@ bool gen_func_begin(const char *id);
 bool gen_func_def_retval(unsigned long idx, keyword kw);
 bool gen_func_set_retval(unsigned long idx);
 bool gen_defvar(char *id);
-bool gen_defvar_str(char *id, unsigned long idx, string *str);
+bool gen_defvar_str(const char *id, unsigned long idx, ir_list *l);
 bool gen_pop(char *arg_id, char *frame);
-bool gen_pop_idx(char *id, char *frame, unsigned long idx);
+bool gen_pop_idx(const char *id, char *frame, unsigned long idx);
 bool gen_get_retval(char *id, char *frame, unsigned long idx);
-bool gen_func_arg(char *arg_id, unsigned long idx, unsigned long scope_idx);
+bool gen_push_retval(unsigned long idx);
+bool gen_func_arg(const char *arg_id, unsigned long idx, unsigned long scope_idx);
 bool gen_func_call(const char *id);
-bool gen_token_value(token *tok);
+ir_operand gen_token_value(token *tok, unsigned long scope_idx);
 bool gen_func_call_arg(unsigned long idx, token *tok);
+
+/**
+ * @brief Operand of the variable id declared in scope scope_idx, GF@%void if id is NULL
+ */
+ir_operand gen_var_operand(const char *id, unsigned long scope_idx);
+
+/**
+ * @brief Generates len, int2float, float2int, ord or chr in place, the results go straight into dst
+ *
+ * substr stays a call of its body, only its arguments and results skip the data stack.
+ *
+ * @param idx Label index used for the range check of ord and chr
+ * @return false if there was an error
+ */
+bool gen_builtin_inline(keyword kw, const char *id, unsigned long idx, ir_operand *args, unsigned long nargs, ir_operand *dst, unsigned long ndst);
+
+/**
+ * @brief Generates MOVE dst src
+ */
+bool gen_move(ir_operand dst, ir_operand src);
 bool gen_func_call_arg_idx(unsigned long idx, token *tok, unsigned long scope_idx);
-bool gen_func_arg_push(token *tok, unsigned long idx);
+
+/**
+ * @brief Generates WRITE of one print argument
+ *
+ * The arguments are written one by one, unlike $print, which pushed them all first.
+ * An argument can only fail to be read if it was never set. That cannot happen, because
+ * := initialises its variable and function results start at their zero value. So no
+ * output is written before a failure.
+ */
+bool gen_write(token *tok, unsigned long scope_idx);
 bool gen_func_return(const char *id);
 bool gen_func_end(const char *id);
 bool gen_create_frame();
 bool gen_label(const char *id, unsigned long idx, unsigned long depth);
-bool gen_if_start(const char *id, unsigned long idx);
+bool gen_if_start(const char *id, unsigned long idx, bool holds_eq);
 bool gen_else(const char *id, unsigned long idx);
 bool gen_endif(const char *id, unsigned long idx);
 bool gen_for_start(const char *id, unsigned long idx);
-bool gen_for_cond(const char *id, unsigned long idx);
+bool gen_for_cond(const char *id, unsigned long idx, bool holds_eq);
 bool gen_endfor(const char *id, unsigned long idx);
-bool gen_builtin_functions();
+
+/**
+ * @brief Adds the code of the builtin function id to the output
+ * @return false if there was an error or id is not a builtin
+ */
+bool gen_builtin_function(const char *id);
 
 #endif
\ No newline at end of file
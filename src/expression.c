@@ -9,7 +9,6 @@
  */
 
 #include "expression.h"
-#include "dll.h"
 #include "error.h"
 #include "scanner.h"
 #include "stack.h"
@@ -46,62 +45,69 @@ const int precedence[7][7] = {
 	{  1,  1,  0,  1,  1,  1, 11 }  // $
 };
 
-static int end_of_expression(data_t *data, dll_t *list, stack *sym_stack);
-static int start_of_expression(data_t *data, dll_t *list, stack *sym_stack);
-static int generate_expression(data_t *data, dll_t *list);
-static int create_symbol(data_t *data, token token, symbol_type type, symbol_t **sym_ptr);
+static int end_of_expression(data_t *data, symbol_vector_t *list, symbol_vector_t *sym_stack);
+static int start_of_expression(data_t *data, symbol_vector_t *list, symbol_vector_t *sym_stack);
+static int generate_expression(data_t *data, symbol_vector_t *list);
+static int create_symbol(data_t *data, token token, symbol_type type, symbol_t *sym);
 static o_type token_to_type(token_type type);
-static int push_symbol(dll_t *list, stack *sym_stack, symbol_t *sym);
+static int push_symbol(symbol_vector_t *list, symbol_vector_t *sym_stack, symbol_t *sym);
 static int gpi(symbol_t *sym);
+static void set_expr_value(data_t *data, symbol_t *sym);
 
-void free_symbol(void *ptr)
+static void symbols_init(symbol_vector_t *v)
 {
-	symbol_t *sym = (symbol_t*)ptr;
-	if (sym->sym_type == SYM_VAR)
-	{ 
-		//data will be cleared from sym tabel
-	}
-	else if (sym->sym_type == SYM_OPERATOR)
-		free(sym->data);
-	else if (sym->sym_type == SYM_STRING)
+	v->items = v->buffer;
+	v->count = 0;
+	v->size = SYMBOL_VECTOR_INLINE;
+}
+
+static bool symbols_push(symbol_vector_t *v, symbol_t *sym)
+{
+	if (v->count == v->size) //move out of the inline buffer or grow
 	{
-		string *s = sym->data;
-		str_free(s);
-		free(s);
+		symbol_t *items = malloc(2 * v->size * sizeof(symbol_t));
+		if (items == NULL)
+			return false;
+		memcpy(items, v->items, v->count * sizeof(symbol_t));
+		if (v->items != v->buffer)
+			free(v->items);
+		v->items = items;
+		v->size *= 2;
 	}
-	else if (sym->sym_type == SYM_INT || sym->sym_type == SYM_FLOAT64)
-		free(sym->data);
-	free(ptr);
+
+	v->items[v->count++] = *sym;
+	return true;
 }
 
-int expression(data_t *data)
+static void symbols_free(symbol_vector_t *v)
 {
-	dll_t *list = dll_init();
-	if (list == NULL)
-		return ERR_INTERNAL;
+	if (v->items != v->buffer)
+		free(v->items);
+	symbols_init(v);
+}
 
-	if (data->vdata == NULL || str_cmp_const(&data->vdata->name, "_") == 0)
+int expression(data_t *data)
+{
+	symbol_vector_t postfix;
+	symbol_vector_t stack;
+	symbol_vector_t *list = &postfix;
+	symbol_vector_t *sym_stack = &stack;
+	symbols_init(list);
+	symbols_init(sym_stack);
+
+	if (data->vdata == NULL || data->vdata->name == data->underscore.name)
 		data->current_type = 't';
 	else
 		data->current_type = data->vdata->type;
 
-	symbol_t *start;
-	NEW_SYMBOL_ERR(data, TKN, SYM_STOP, &start)
-	{
-		dll_dispose(list, stack_nofree);
-		RET()
-	}
-
-	stack sym_stack;
-	stack_init(&sym_stack);
-	if (!stack_push(&sym_stack, start)) //push $
-	{
-		dll_dispose(list, stack_nofree);
-		return ERR_INTERNAL;
-	}
+	symbol_t start;
+	NEW_SYMBOL(data, TKN, SYM_STOP, &start);
+	symbols_push(sym_stack, &start); //push $, fits into the inline buffer
 
 	data->used_relations = false;
-	int r = start_of_expression(data, list, &sym_stack);
+	data->const_cond = false;
+	data->expr_value.type = '0';
+	int r = start_of_expression(data, list, sym_stack);
 	if (r == 0 && TKN.type != TOKEN_PAR_OPEN)
 	{
 		if (data->used_relations && !data->allow_relations)
@@ -114,14 +120,22 @@ int expression(data_t *data)
 				data->vdata->type = data->current_type;
 
 			r = optimize(data, list);
-			if (r == 0)
+			if (r == 0 && list->count == 1 && list->items[0].sym_type == SYM_BOOL)
+			{
+				//the condition is known, nothing is evaluated at runtime
+				data->const_cond = true;
+				data->cond_value = list->items[0].data.bool_val;
+			}
+			else if (r == 0)
 			{
+				if (list->count == 1)
+					set_expr_value(data, &list->items[0]);
 				r = generate_expression(data, list);
 			}
 		}
 	}
-	stack_dispose(&sym_stack, free_symbol);
-	dll_dispose(list, free_symbol);
+	symbols_free(sym_stack);
+	symbols_free(list);
 	return r;
 }
 
@@ -136,7 +150,7 @@ static symbol_type token_to_sym(token_type type)
 	return 0;
 }
 
-static int start_of_expression(data_t *data, dll_t *list, stack *sym_stack)
+static int start_of_expression(data_t *data, symbol_vector_t *list, symbol_vector_t *sym_stack)
 {
 	if (TKN.type == TOKEN_IDENTIFIER) //func or var
 	{
@@ -145,9 +159,9 @@ static int start_of_expression(data_t *data, dll_t *list, stack *sym_stack)
 	}
 	else if (TKN.type == TOKEN_INT || TKN.type == TOKEN_STRING || TKN.type == TOKEN_FLOAT64) //constants
 	{
-		symbol_t *sym;
+		symbol_t sym;
 		NEW_SYMBOL(data, TKN, token_to_sym(TKN.type), &sym);
-		data->result = push_symbol(list, sym_stack, sym);
+		data->result = push_symbol(list, sym_stack, &sym);
 		CHECK_RESULT()
 
 		data->allow_func = false;
@@ -156,9 +170,9 @@ static int start_of_expression(data_t *data, dll_t *list, stack *sym_stack)
 	}
 	else if (TKN.type == TOKEN_PAR_OPEN) //priority brackets
 	{	
-		symbol_t *sym;
+		symbol_t sym;
 		NEW_SYMBOL(data, TKN, SYM_OPEN, &sym);
-		data->result = push_symbol(list, sym_stack, sym);
+		data->result = push_symbol(list, sym_stack, &sym);
 		CHECK_RESULT()
 
 		data->allow_func = false;	
@@ -178,13 +192,13 @@ static int start_of_expression(data_t *data, dll_t *list, stack *sym_stack)
 	return ERR_SYNTAX;
 }
 
-static int end_of_expression(data_t *data, dll_t *list, stack *sym_stack)
+static int end_of_expression(data_t *data, symbol_vector_t *list, symbol_vector_t *sym_stack)
 {
-	symbol_t *sym;
+	symbol_t sym;
 	if (TKN.type != TOKEN_PAR_OPEN && data->prev_token.type == TOKEN_IDENTIFIER)
 	{
 		NEW_SYMBOL(data, data->prev_token, SYM_VAR, &sym);
-		data->result = push_symbol(list, sym_stack, sym);
+		data->result = push_symbol(list, sym_stack, &sym);
 		CHECK_RESULT()
 	}
 
@@ -196,7 +210,7 @@ static int end_of_expression(data_t *data, dll_t *list, stack *sym_stack)
 				return ERR_SEMANTIC_TYPE_COMPAT;
 
 			NEW_SYMBOL(data, TKN, SYM_OPERATOR, &sym);
-			data->result = push_symbol(list, sym_stack, sym);
+			data->result = push_symbol(list, sym_stack, &sym);
 			CHECK_RESULT()
 
 			data->allow_func = false;
@@ -212,7 +226,7 @@ static int end_of_expression(data_t *data, dll_t *list, stack *sym_stack)
 			data->used_relations = true;
 
 			NEW_SYMBOL(data, TKN, SYM_OPERATOR, &sym);
-			data->result = push_symbol(list, sym_stack, sym);
+			data->result = push_symbol(list, sym_stack, &sym);
 			CHECK_RESULT()
 
 			data->allow_func = false;
@@ -222,7 +236,7 @@ static int end_of_expression(data_t *data, dll_t *list, stack *sym_stack)
 		//end of priority brackets
 		case TOKEN_PAR_CLOSE:
 			NEW_SYMBOL(data, TKN, SYM_CLOSE, &sym);
-			data->result = push_symbol(list, sym_stack, sym);
+			data->result = push_symbol(list, sym_stack, &sym);
 			CHECK_RESULT()
 
 			APPLY_NEXT_RULE(end_of_expression)
@@ -231,7 +245,7 @@ static int end_of_expression(data_t *data, dll_t *list, stack *sym_stack)
 		//end of expression
 		case TOKEN_COMMA: case TOKEN_EOL: case TOKEN_CURLY_OPEN: case TOKEN_SEMICOLON:
 			NEW_SYMBOL(data, TKN, SYM_STOP, &sym);
-			data->result = push_symbol(list, sym_stack, sym); //$
+			data->result = push_symbol(list, sym_stack, &sym); //$
 			CHECK_RESULT()
 
 			return 0;
@@ -277,146 +291,146 @@ static o_type token_to_type(token_type type)
 	}
 }
 
-static int push_symbol(dll_t *list, stack *sym_stack, symbol_t *sym)
+static int push_symbol(symbol_vector_t *list, symbol_vector_t *sym_stack, symbol_t *sym)
 {
 	int current = gpi(sym);
 	while (true)
 	{
-		symbol_t *sym2 = (symbol_t*)sym_stack->top->data;
+		symbol_t *sym2 = &sym_stack->items[sym_stack->count - 1]; //$ is never popped
 
 		int prec = precedence[current][gpi(sym2)];
 		if (prec == 1) //reduce
 		{
 			if (sym2->sym_type < SYM_STOP)
-				if (!dll_insert_last(list, sym2))
+				if (!symbols_push(list, sym2))
 					return ERR_INTERNAL;
 		}
 		else if (prec == 10) //()
 		{
-			stack_pop(sym_stack, free_symbol);
-			free_symbol(sym);
+			sym_stack->count--;
 			return 0;
 		}
 		else if (prec == -1) //shift
 			break;
 		else if (prec == 11) //$$
-		{
-			free_symbol(sym);
 			return 0;
-		}
 		else //missing ( or )
-		{
-			free_symbol(sym);
 			return ERR_SYNTAX;
-		}
 
-		stack_pop(sym_stack, stack_nofree);
+		sym_stack->count--;
 	}
 
-	if (!stack_push(sym_stack, sym))
+	if (!symbols_push(sym_stack, sym))
 		return ERR_INTERNAL;
 	return 0;
 }
 
-static int create_symbol(data_t *data, token token, symbol_type type, symbol_t **sym_ptr)
+static int create_symbol(data_t *data, token token, symbol_type type, symbol_t *sym)
 {
-	*sym_ptr = malloc(sizeof(symbol_t));
-	symbol_t *sym = *sym_ptr;
-	if (sym == NULL)
-		return ERR_INTERNAL;
-
 	sym->sym_type = type;
+	sym->propagated = false;
 	if (type == SYM_OPERATOR) //operator
-	{
-		sym->data = malloc(sizeof(o_type)); //currently loaded operator
-		if (sym->data == NULL)
-		{
-			free(sym);
-			return ERR_INTERNAL;
-		}
-		*(o_type*)sym->data = token_to_type(token.type);
-	}
+		sym->data.op = token_to_type(token.type); //currently loaded operator
 	else if (type == SYM_INT) //int64 (long)
 	{
-		sym->data = malloc(sizeof(long));
-		if (sym->data == NULL)
-		{
-			free(sym);
-			return ERR_INTERNAL;
-		}
-		*(long*)sym->data = token.attr.int_val;
+		sym->data.int_val = token.attr.int_val;
 		data->current_type = compare_types('i', data->current_type);
 	}
 	else if (type == SYM_FLOAT64) //float64 (double)
 	{
-		sym->data = malloc(sizeof(double));
-		if (sym->data == NULL)
-		{
-			free(sym);
-			return ERR_INTERNAL;
-		}
-		*(double*)sym->data = token.attr.float64_val;
+		sym->data.float64_val = token.attr.float64_val;
 		data->current_type = compare_types('f', data->current_type);
 	}
 	else if (type == SYM_STRING) //string
 	{
-		string *str = malloc(sizeof(string));
+		string *str = arena_alloc(&data->func_arena, sizeof(string));
 		if (str == NULL)
-		{
-			free(sym);
 			return ERR_INTERNAL;
-		}
 
-		if (!str_init(str))
-		{
-			free(str);
-			free(sym);
+		//read-only copy, the scanner reuses its string for the next token
+		str->str = arena_strndup(&data->func_arena, token.attr.str->str, token.attr.str->len);
+		if (str->str == NULL)
 			return ERR_INTERNAL;
-		}
+		str->len = token.attr.str->len;
+		str->mem_size = str->len + 1;
 
-		if (!str_add_const(str, token.attr.str->str))
-		{
-			free_symbol(sym);
-			return ERR_INTERNAL;
-		}
-
-		sym->data = str;
+		sym->data.str = str;
 		data->current_type = compare_types('s', data->current_type);
 	}
 	else if (type == SYM_VAR) //identifier
 	{
-		var_data_t *var = find_var(data, token.attr.str->str, false);
+		var_data_t *var = find_var(data, token.attr.id, false);
 		if (var == NULL)
-		{
-			free(sym);
 			return ERR_SEMANTIC_UNDEF_REDEF;
-		}
 
-		sym->data = var;
+		sym->data.var = var;
 		data->current_type = compare_types(var->type, data->current_type);
-		if (data->current_type == '0')
+
+		//a value known at compile time replaces the variable
+		var_value_t *value = &var->value;
+		if (value->type == 'v' && value->val.var->version == value->version)
+			sym->data.var = value->val.var;
+		else if (value->type == 'i' || value->type == 'f' || value->type == 's')
 		{
-			free_symbol(sym);
-			return ERR_SEMANTIC_TYPE_COMPAT;
+			sym->propagated = true;
+			if (value->type == 'i')
+			{
+				sym->sym_type = SYM_INT;
+				sym->data.int_val = value->val.int_val;
+			}
+			else if (value->type == 'f')
+			{
+				sym->sym_type = SYM_FLOAT64;
+				sym->data.float64_val = value->val.float64_val;
+			}
+			else
+			{
+				sym->sym_type = SYM_STRING;
+				sym->data.str = value->val.str;
+			}
 		}
 	}
 
 	if (data->current_type == '0')
-	{
-		free_symbol(sym);
 		return ERR_SEMANTIC_TYPE_COMPAT;
-	}
 	return 0;
 }
 
+/**
+ * @brief Remembers the value of an expression reduced to a single symbol
+ */
+static void set_expr_value(data_t *data, symbol_t *sym)
+{
+	switch (sym->sym_type)
+	{
+		case SYM_INT:
+			data->expr_value.type = 'i';
+			data->expr_value.val.int_val = sym->data.int_val;
+			break;
+		case SYM_FLOAT64:
+			data->expr_value.type = 'f';
+			data->expr_value.val.float64_val = sym->data.float64_val;
+			break;
+		case SYM_STRING:
+			data->expr_value.type = 's';
+			data->expr_value.val.str = sym->data.str;
+			break;
+		case SYM_VAR:
+			data->expr_value.type = 'v';
+			data->expr_value.val.var = sym->data.var;
+			data->expr_value.version = sym->data.var->version;
+			break;
+		default:
+			break;
+	}
+}
+
 static int gpi(symbol_t *sym)
 {
-	o_type *type;
 	switch (sym->sym_type)
 	{
 		case SYM_OPERATOR:
-			type = (o_type*)sym->data;
-			switch (*type)
+			switch (sym->data.op)
 			{
 				case S_ADD: case S_SUB:
 					return 0;
@@ -436,114 +450,141 @@ static int gpi(symbol_t *sym)
 	}
 }
 
-static int generate_expression(data_t *data, dll_t *list)
+static int generate_expression(data_t *data, symbol_vector_t *list)
 {
 	token tmp_tok;
-	string tmp_str;
-	tmp_tok.attr.str = &tmp_str;
-	dll_node_t *tmp = list->first;
 
 	if (data->assign_for && data->assign_for_swap_output)
 	{
-		string tmp_swap = ifjcode20_output;
-		ifjcode20_output = for_assigns;
-		for_assigns = tmp_swap;
+		ir_swap(&ifjcode20_code, &for_assigns);
 		data->assign_for_swap_output = false;
 	}
 
-	while (tmp != NULL)
+	for (unsigned int i = 0; i < list->count; i++)
 	{
-		switch (((symbol_t*)tmp->data)->sym_type)
+		symbol_t *sym = &list->items[i];
+		switch (sym->sym_type)
 		{
 			case SYM_OPERATOR:
-				switch (*((o_type*)((symbol_t*)tmp->data)->data))
+				switch (sym->data.op)
 				{
 					case S_ADD:
 						if (data->current_type == 's')
 						{
-							CODE_INT("POPS GF@%%tmp2\n"\
-									"POPS GF@%%tmp1\n"\
-									"CONCAT GF@%%tmp0 GF@%%tmp1 GF@%%tmp2\n"\
-									"PUSHS GF@%%tmp0\n");
+							INSTR_INT(IR_POPS, OP_VAR("GF@%%tmp2"));
+							INSTR_INT(IR_POPS, OP_VAR("GF@%%tmp1"));
+							INSTR_INT(IR_CONCAT, OP_VAR("GF@%%tmp0"), OP_VAR("GF@%%tmp1"), OP_VAR("GF@%%tmp2"));
+							INSTR_INT(IR_PUSHS, OP_VAR("GF@%%tmp0"));
 						}
 						else
 						{
-							CODE_INT("ADDS\n");
+							INSTR_INT(IR_ADDS);
 						}
 						break;
 					case S_SUB:
-						CODE_INT("SUBS\n");
+						INSTR_INT(IR_SUBS);
 						break;
 					case S_MUL:
-						CODE_INT("MULS\n");
+						INSTR_INT(IR_MULS);
 						break;
 					case S_DIV:
 						if (data->current_type == 'i')
 						{
-							if (*((long*)((symbol_t*)tmp->prev->data)->data) == 0L)
-								return ERR_ZERO_DIVISION;
+							if (sym[-1].sym_type == SYM_INT && !(sym[-1].propagated && sym[-1].data.int_val == 0L)) //constant divisor, checked here
+							{
+								if (sym[-1].data.int_val == 0L)
+									return ERR_ZERO_DIVISION;
+								INSTR_INT(IR_IDIVS);
+								break;
+							}
 
 							// Detect int zero division at runtime
-							CODE_INT("POPS GF@%%tmp0\n"\
-									"JUMPIFNEQ $", data->fdata->name.str, "$"); CODE_NUM(data->label_idx+1);
-							CODE_INT("$diverr GF@%%tmp0 int@0\n"\
-									"EXIT int@9\n"\
-									"LABEL $", data->fdata->name.str, "$");
-							CODE_NUM(++data->label_idx); CODE_INT("$diverr\n"\
-									"PUSHS GF@%%tmp0\n");
-
-							CODE_INT("IDIVS\n");
+							data->label_idx++;
+							INSTR_INT(IR_POPS, OP_VAR("GF@%%tmp0"));
+							INSTR_INT(IR_JUMPIFNEQ, OP_LABEL("$%s$%lu$diverr", data->fdata->name.str, data->label_idx), OP_VAR("GF@%%tmp0"), OP_CONST("int@0"));
+							INSTR_INT(IR_EXIT, OP_CONST("int@9"));
+							INSTR_INT(IR_LABEL, OP_LABEL("$%s$%lu$diverr", data->fdata->name.str, data->label_idx));
+							INSTR_INT(IR_PUSHS, OP_VAR("GF@%%tmp0"));
+
+							INSTR_INT(IR_IDIVS);
 						}
 						else
 						{
-							if (*((double*)((symbol_t*)tmp->prev->data)->data) == 0.0)
-								return ERR_ZERO_DIVISION;
+							if (sym[-1].sym_type == SYM_FLOAT64 && !(sym[-1].propagated && sym[-1].data.float64_val == 0.0)) //constant divisor, checked here
+							{
+								if (sym[-1].data.float64_val == 0.0)
+									return ERR_ZERO_DIVISION;
+								INSTR_INT(IR_DIVS);
+								break;
+							}
 
 							// Detect float zero division at runtime
-							CODE_INT("POPS GF@%%tmp0\n"\
-									"JUMPIFNEQ $", data->fdata->name.str, "$"); CODE_NUM(data->label_idx+1);
-							CODE_INT("$diverr GF@%%tmp0 float@0x0p+0\n"\
-									"EXIT int@9\n"\
-									"LABEL $", data->fdata->name.str, "$");
-							CODE_NUM(++data->label_idx); CODE_INT("$diverr\n"\
-									"PUSHS GF@%%tmp0\n");
-
-							CODE_INT("DIVS\n");
+							data->label_idx++;
+							INSTR_INT(IR_POPS, OP_VAR("GF@%%tmp0"));
+							INSTR_INT(IR_JUMPIFNEQ, OP_LABEL("$%s$%lu$diverr", data->fdata->name.str, data->label_idx), OP_VAR("GF@%%tmp0"), OP_CONST("float@0x0p+0"));
+							INSTR_INT(IR_EXIT, OP_CONST("int@9"));
+							INSTR_INT(IR_LABEL, OP_LABEL("$%s$%lu$diverr", data->fdata->name.str, data->label_idx));
+							INSTR_INT(IR_PUSHS, OP_VAR("GF@%%tmp0"));
+
+							INSTR_INT(IR_DIVS);
 						}
 						break;
+					//relations are only in conditions, the operands stay on the stack for the jump
 					case S_EQ:
-						CODE_INT("EQS\n");
+						data->cond_holds_eq = true;
 						break;
 					case S_NEQ:
-						CODE_INT("EQS\nNOTS\n");
+						data->cond_holds_eq = false;
 						break;
 					case S_LT:
-						CODE_INT("LTS\n");
+						INSTR_INT(IR_LTS);
+						INSTR_INT(IR_PUSHS, OP_CONST("bool@true"));
+						data->cond_holds_eq = true;
 						break;
 					case S_GT:
-						CODE_INT("GTS\n");
+						INSTR_INT(IR_GTS);
+						INSTR_INT(IR_PUSHS, OP_CONST("bool@true"));
+						data->cond_holds_eq = true;
 						break;
 					case S_LTE:
-						CODE_INT("POPS GF@%%tmp0\n"\
-								"POPS GF@%%tmp1\n"\
-								"PUSHS GF@%%tmp1\n"\
-								"PUSHS GF@%%tmp0\n"\
-								"LTS\n"\
-								"PUSHS GF@%%tmp1\n"\
-								"PUSHS GF@%%tmp0\n"\
-								"EQS\n"\
-								"ORS\n");
+						if (data->current_type != 'f') //ints and strings are totally ordered, a <= b is !(a > b)
+						{
+							INSTR_INT(IR_GTS);
+							INSTR_INT(IR_PUSHS, OP_CONST("bool@true"));
+							data->cond_holds_eq = false;
+							break;
+						}
+						INSTR_INT(IR_POPS, OP_VAR("GF@%%tmp0"));
+						INSTR_INT(IR_POPS, OP_VAR("GF@%%tmp1"));
+						INSTR_INT(IR_PUSHS, OP_VAR("GF@%%tmp1"));
+						INSTR_INT(IR_PUSHS, OP_VAR("GF@%%tmp0"));
+						INSTR_INT(IR_LTS);
+						INSTR_INT(IR_PUSHS, OP_VAR("GF@%%tmp1"));
+						INSTR_INT(IR_PUSHS, OP_VAR("GF@%%tmp0"));
+						INSTR_INT(IR_EQS);
+						INSTR_INT(IR_ORS);
+						INSTR_INT(IR_PUSHS, OP_CONST("bool@true"));
+						data->cond_holds_eq = true;
 						break;
 					case S_GTE:
-						CODE_INT("POPS GF@%%tmp0\n"\
-								"POPS GF@%%tmp1\n"\
-								"PUSHS GF@%%tmp1\n"\
-								"PUSHS GF@%%tmp0\n"\
-								"GTS\n"\
-								"PUSHS GF@%%tmp1\n"\
-								"PUSHS GF@%%tmp0\n"\
-								"EQS\n"\
-								"ORS\n");
+						if (data->current_type != 'f') //a >= b is !(a < b), NaN keeps floats on the long way
+						{
+							INSTR_INT(IR_LTS);
+							INSTR_INT(IR_PUSHS, OP_CONST("bool@true"));
+							data->cond_holds_eq = false;
+							break;
+						}
+						INSTR_INT(IR_POPS, OP_VAR("GF@%%tmp0"));
+						INSTR_INT(IR_POPS, OP_VAR("GF@%%tmp1"));
+						INSTR_INT(IR_PUSHS, OP_VAR("GF@%%tmp1"));
+						INSTR_INT(IR_PUSHS, OP_VAR("GF@%%tmp0"));
+						INSTR_INT(IR_GTS);
+						INSTR_INT(IR_PUSHS, OP_VAR("GF@%%tmp1"));
+						INSTR_INT(IR_PUSHS, OP_VAR("GF@%%tmp0"));
+						INSTR_INT(IR_EQS);
+						INSTR_INT(IR_ORS);
+						INSTR_INT(IR_PUSHS, OP_CONST("bool@true"));
+						data->cond_holds_eq = true;
 						break;
 					default:
 						break;
@@ -551,36 +592,27 @@ static int generate_expression(data_t *data, dll_t *list)
 				break;
 			case SYM_INT:
 				tmp_tok.type = TOKEN_INT;
-				tmp_tok.attr.int_val = *((long*)((symbol_t*)tmp->data)->data);
-				CODE_INT("PUSHS ");
-				GEN(gen_token_value, &tmp_tok);
-				CODE_INT("\n");
+				tmp_tok.attr.int_val = sym->data.int_val;
+				INSTR_INT(IR_PUSHS, gen_token_value(&tmp_tok, 0));
 				break;
 			case SYM_FLOAT64:
 				tmp_tok.type = TOKEN_FLOAT64;
-				tmp_tok.attr.float64_val = *((double*)((symbol_t*)tmp->data)->data);
-				CODE_INT("PUSHS ");
-				GEN(gen_token_value, &tmp_tok);
-				CODE_INT("\n");
+				tmp_tok.attr.float64_val = sym->data.float64_val;
+				INSTR_INT(IR_PUSHS, gen_token_value(&tmp_tok, 0));
 				break;
 			case SYM_STRING:
 				tmp_tok.type = TOKEN_STRING;
-				tmp_tok.attr.str = (string*)((symbol_t*)tmp->data)->data;
-				CODE_INT("PUSHS ");
-				GEN(gen_token_value, &tmp_tok);
-				CODE_INT("\n");
+				tmp_tok.attr.str = sym->data.str;
+				INSTR_INT(IR_PUSHS, gen_token_value(&tmp_tok, 0));
 				break;
 			case SYM_VAR:
 				tmp_tok.type = TOKEN_IDENTIFIER;
-				tmp_tok.attr.str = &((var_data_t*)((symbol_t*)tmp->data)->data)->name;
-				CODE_INT("PUSHS ");
-				GEN(gen_token_value, &tmp_tok); CODE("%%"); CODE_NUM(((var_data_t*)((symbol_t*)tmp->data)->data)->scope_idx);
-				CODE_INT("\n");
+				tmp_tok.attr.id = sym->data.var->name;
+				INSTR_INT(IR_PUSHS, gen_token_value(&tmp_tok, sym->data.var->scope_idx));
 				break;
 			default:
 				break;
 		}
-		tmp = tmp->next;
 	}
 	return 0;
 }
@@ -28,15 +28,39 @@ typedef enum
 	SYM_FLOAT64 = 4,
 	SYM_STOP = 5, //$
 	SYM_OPEN = 6, //(
-	SYM_CLOSE = 7 //)
+	SYM_CLOSE = 7, //)
+	SYM_BOOL = 8 //relation of constants folded by the optimizer
 } symbol_type;
 
 typedef struct 
 {
 	symbol_type sym_type;
-	void *data; //pointer to: var_type or o_type or constant
+	bool propagated; //constant known from an earlier assignment, a zero divisor fails at runtime only
+	union
+	{
+		o_type op;	    //SYM_OPERATOR
+		var_data_t *var;    //SYM_VAR
+		long int_val;	    //SYM_INT
+		double float64_val; //SYM_FLOAT64
+		string *str;	    //SYM_STRING, read-only copy in the function arena
+		bool bool_val;	    //SYM_BOOL
+	} data;
 } symbol_t;
 
+#define SYMBOL_VECTOR_INLINE 32 //symbols stored without allocation, enough for most expressions
+
+/**
+ * @brief Contiguous growable array of symbols, used for the postfix form and the precedence stack
+ * 
+ */
+typedef struct
+{
+	symbol_t *items; //points to buffer until the vector outgrows it
+	unsigned int count;
+	unsigned int size;
+	symbol_t buffer[SYMBOL_VECTOR_INLINE];
+} symbol_vector_t;
+
 /**
  * @brief Parse expression
  * 
@@ -45,6 +69,4 @@ typedef struct
  */
 int expression(data_t* data);
 
-void free_symbol(void *ptr);
-
 #endif
@@ -15,8 +15,15 @@
 #include "enum_str.h"
 #include "codegen.h"
 
-int main()
+int main(int argc, char *argv[])
 {
+    // the source is read from stdin unless a file path is given
+    if (scanner_open(argc > 1 ? argv[1] : NULL) != SCANNER_SUCCESS)
+    {
+        fprintf(stderr, "error: cannot read the source\n");
+        return ERR_INTERNAL;
+    }
+
     string s;
     GEN(str_init, &s);
     set_token_string_attr(&s);
@@ -24,9 +31,6 @@ int main()
     data_t data;
     GEN(init_data, &data);
     GEN(gen_codegen_init);
-    GEN(str_init, &for_assigns);
-    GEN(str_init, &func_declarations);
-    GEN(str_init, &func_body);
 
     int result = parse(&data);
     if (result != 0)
@@ -36,7 +40,7 @@ int main()
             if (data.token.type == TOKEN_KEYWORD)
                 fprintf(stderr, "syntax error: unexpected token keyword %s at line %d\n", keyword_str(data.token.attr.kw), data.token.line);
             else if (data.token.type == TOKEN_IDENTIFIER)
-                fprintf(stderr, "syntax error: unexpected identifier '%s' at line %d\n", data.token.attr.str->str, data.token.line);
+                fprintf(stderr, "syntax error: unexpected identifier '%s' at line %d\n", data.token.attr.id->str, data.token.line);
             else
                 fprintf(stderr, "syntax error: unexpected token '%s' at line %d\n", token_str(data.token.type), data.token.line);
             fprintf(stderr, "token sequence: %s %s\n", token_str(data.prev_token.type), token_str(data.token.type));
@@ -51,10 +55,9 @@ int main()
     
     dispose_data(&data);
     str_free(&s);
-    str_free(&ifjcode20_output);
-    str_free(&for_assigns);
-    str_free(&func_declarations);
-    str_free(&func_body);
+    gen_codegen_free();
+    atom_table_free();
+    scanner_close();
 
     return result;
 }
@@ -0,0 +1,463 @@
+/**
+ * Project name: Imperative language IFJ20 compiler implementation
+ * Název projektu: Implementace překladače imperativního jazyka IFJ20
+ *
+ * @brief Function inliner implementation
+ *
+ * @author Daniel Moudrý <xmoudr01 at stud.fit.vutbr.cz>
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include "inliner.h"
+#include "symtable.h"
+
+#define MAX_ARGS 16
+#define UNVISITED UINT_MAX
+
+typedef struct {
+    ir_func **funcs;
+    unsigned int count;
+    symtable_ptr names; // name -> &funcs[f]
+    size_t *first; // the calls of f are callees[first[f]..first[f + 1])
+    unsigned int *callees;
+    unsigned int *component; // strongly connected component of each function
+    bool *recursive; // calls itself directly or through other functions
+    unsigned int *order; // functions by components, callees before their callers
+    unsigned long *sites; // number of calls of each function left in the code
+} graph_t;
+
+static void keep(void *data);
+static bool graph_init(graph_t *g, ir_func **funcs, unsigned int count);
+static void graph_free(graph_t *g);
+static bool components(graph_t *g);
+static int find(graph_t *g, const char *label);
+static void count_calls(graph_t *g, ir_list *code, bool add);
+static bool is_param(const char *text);
+static long scope_of(const char *text, int *len);
+static long max_scope(ir_list *code);
+static int cost(ir_func *f, unsigned int *params);
+static bool ends_call(ir_opcode op);
+static bool rename_operand(ir_func *f, ir_operand *o, long base, symtable_ptr labels, const ir_operand *args);
+static bool inline_call(graph_t *g, ir_func *f, unsigned int callee, ir_operand *args, long *scope, ir_list *out, ir_list *decls);
+static bool inline_calls(graph_t *g, unsigned int f);
+static bool mark_called(graph_t *g);
+
+bool inliner(ir_func **funcs, unsigned int count) {
+    graph_t g;
+    bool ok = graph_init(&g, funcs, count) && components(&g);
+
+    // callees first, the functions of a cycle are not inlined into each other
+    for (unsigned int i = 0; ok && i < count; i++)
+        ok = inline_calls(&g, g.order[i]);
+
+    ok = ok && mark_called(&g);
+    graph_free(&g);
+    return ok;
+}
+
+static void keep(void *data) {
+    (void)data; // the table only refers to the data
+}
+
+/**
+ * Collects the calls of every function.
+ */
+static bool graph_init(graph_t *g, ir_func **funcs, unsigned int count) {
+    g->funcs = funcs;
+    g->count = count;
+    symtable_init(&g->names);
+    g->first = malloc((count + 1) * sizeof(size_t));
+    g->callees = NULL;
+    g->component = malloc((count + 1) * sizeof(unsigned int));
+    g->recursive = calloc(count + 1, sizeof(bool));
+    g->order = malloc((count + 1) * sizeof(unsigned int));
+    g->sites = calloc(count + 1, sizeof(unsigned long));
+    if (g->first == NULL || g->component == NULL || g->recursive == NULL || g->order == NULL || g->sites == NULL)
+        return false;
+
+    for (unsigned int f = 0; f < count; f++) {
+        bool error = false;
+        stnode_ptr node = symtable_insert(&g->names, funcs[f]->name, &error);
+        if (node == NULL)
+            return false;
+        node->data = &funcs[f];
+    }
+
+    size_t calls = 0;
+    for (unsigned int f = 0; f < count; f++) {
+        g->first[f] = calls;
+        for (unsigned int i = 0; i < funcs[f]->code.count; i++) {
+            ir_instr *instr = &funcs[f]->code.items[i];
+            calls += instr->op == IR_CALL && find(g, instr->args[0].text) >= 0;
+        }
+    }
+    g->first[count] = calls;
+    if ((g->callees = malloc((calls + 1) * sizeof(unsigned int))) == NULL)
+        return false;
+    for (unsigned int f = 0; f < count; f++) {
+        size_t k = g->first[f];
+        for (unsigned int i = 0; i < funcs[f]->code.count; i++) {
+            ir_instr *instr = &funcs[f]->code.items[i];
+            int callee = instr->op == IR_CALL ? find(g, instr->args[0].text) : -1;
+            if (callee >= 0) {
+                g->callees[k++] = callee;
+                g->sites[callee]++;
+            }
+        }
+    }
+    return true;
+}
+
+static void graph_free(graph_t *g) {
+    symtable_dispose(&g->names, keep);
+    free(g->first);
+    free(g->callees);
+    free(g->component);
+    free(g->recursive);
+    free(g->order);
+    free(g->sites);
+}
+
+/**
+ * Tarjan's algorithm without recursion, a component is complete only after all
+ * the components it calls, which gives the order of the functions.
+ */
+static bool components(graph_t *g) {
+    unsigned int n = g->count;
+    unsigned int *index = malloc((n + 1) * sizeof(unsigned int));
+    unsigned int *low = malloc((n + 1) * sizeof(unsigned int));
+    unsigned int *stack = malloc((n + 1) * sizeof(unsigned int)); // visited, component not complete
+    unsigned int *path = malloc((n + 1) * sizeof(unsigned int)); // functions being visited
+    size_t *next = malloc((n + 1) * sizeof(size_t)); // next call to follow
+    bool *on_stack = calloc(n + 1, sizeof(bool));
+    bool ok = index != NULL && low != NULL && stack != NULL && path != NULL && next != NULL && on_stack != NULL;
+
+    unsigned int visited = 0, top = 0, depth = 0, ordered = 0, component = 0;
+    for (unsigned int f = 0; ok && f < n; f++)
+        index[f] = UNVISITED;
+    for (unsigned int root = 0; ok && root < n; root++) {
+        if (index[root] != UNVISITED)
+            continue;
+        path[depth++] = root;
+        index[root] = low[root] = visited++;
+        next[root] = g->first[root];
+        stack[top++] = root;
+        on_stack[root] = true;
+
+        while (depth > 0) {
+            unsigned int v = path[depth - 1];
+            if (next[v] < g->first[v + 1]) {
+                unsigned int w = g->callees[next[v]++];
+                if (w == v)
+                    g->recursive[v] = true;
+                if (index[w] == UNVISITED) {
+                    path[depth++] = w;
+                    index[w] = low[w] = visited++;
+                    next[w] = g->first[w];
+                    stack[top++] = w;
+                    on_stack[w] = true;
+                }
+                else if (on_stack[w] && index[w] < low[v]) {
+                    low[v] = index[w];
+                }
+                continue;
+            }
+
+            depth--;
+            if (depth > 0 && low[v] < low[path[depth - 1]])
+                low[path[depth - 1]] = low[v];
+            if (low[v] != index[v])
+                continue;
+            unsigned int start = ordered, w;
+            do {
+                w = stack[--top];
+                on_stack[w] = false;
+                g->component[w] = component;
+                g->order[ordered++] = w;
+            } while (w != v);
+            for (unsigned int i = start; ordered - start > 1 && i < ordered; i++)
+                g->recursive[g->order[i]] = true;
+            component++;
+        }
+    }
+
+    free(index);
+    free(low);
+    free(stack);
+    free(path);
+    free(next);
+    free(on_stack);
+    return ok;
+}
+
+/**
+ * Returns the index of the function with the entry label, -1 for a builtin.
+ */
+static int find(graph_t *g, const char *label) {
+    stnode_ptr node = label[0] == '$' ? symtable_search(g->names, label + 1) : NULL;
+    return node == NULL ? -1 : (int)((ir_func**)node->data - g->funcs);
+}
+
+/**
+ * Adds the calls in the code to the numbers of call sites, or removes them.
+ */
+static void count_calls(graph_t *g, ir_list *code, bool add) {
+    for (unsigned int i = 0; i < code->count; i++) {
+        int callee = code->items[i].op == IR_CALL ? find(g, code->items[i].args[0].text) : -1;
+        if (callee >= 0 && add)
+            g->sites[callee]++;
+        else if (callee >= 0)
+            g->sites[callee]--;
+    }
+}
+
+/**
+ * Checks whether the operand is a parameter LF@%n.
+ */
+static bool is_param(const char *text) {
+    if (strncmp(text, "LF@%", 4) != 0 || text[4] == '\0')
+        return false;
+    for (const char *c = text + 4; *c != '\0'; c++) {
+        if (!isdigit((unsigned char)*c))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Returns the scope index of the local variable LF@name%idx, len is set to the length of name.
+ * Names without an index like %retval0 are in scope 0.
+ */
+static long scope_of(const char *text, int *len) {
+    const char *name = text + 3;
+    const char *idx = strrchr(name, '%');
+    *len = strlen(name);
+    if (idx == NULL || idx[1] == '\0')
+        return 0;
+    for (const char *c = idx + 1; *c != '\0'; c++) {
+        if (!isdigit((unsigned char)*c))
+            return 0;
+    }
+    *len = idx - name;
+    return strtol(idx + 1, NULL, 10);
+}
+
+static long max_scope(ir_list *code) {
+    long max = 0;
+    for (unsigned int i = 0; i < code->count; i++) {
+        for (unsigned int j = 0; j < code->items[i].nargs; j++) {
+            const char *text = code->items[i].args[j].text;
+            int len;
+            if (strncmp(text, "LF@", 3) == 0 && !is_param(text) && scope_of(text, &len) > max)
+                max = scope_of(text, &len);
+        }
+    }
+    return max;
+}
+
+/**
+ * Returns the number of instructions a call would be replaced by, -1 if the function
+ * cannot be inlined. Its frame may only be pushed at the entry and popped at the end
+ * and the parameters may only be copied into the variables, params is set to their number.
+ */
+static int cost(ir_func *f, unsigned int *params) {
+    ir_instr *code = f->code.items;
+    unsigned int count = f->code.count;
+    if (count < 4 || code[0].op != IR_LABEL || strcmp(code[0].args[0].text + 1, f->name) != 0
+        || code[1].op != IR_PUSHFRAME || code[count - 2].op != IR_POPFRAME || code[count - 1].op != IR_RETURN)
+        return -1;
+
+    int size = 0;
+    *params = 0;
+    for (unsigned int i = 2; i < count - 2; i++) {
+        if (code[i].op == IR_PUSHFRAME || code[i].op == IR_POPFRAME || code[i].op == IR_RETURN)
+            return -1;
+        for (unsigned int j = 0; j < code[i].nargs; j++) {
+            if (!is_param(code[i].args[j].text))
+                continue;
+            if (code[i].op != IR_MOVE || j != 1)
+                return -1;
+            unsigned long idx = strtoul(code[i].args[j].text + 4, NULL, 10);
+            if (idx >= *params)
+                *params = idx + 1;
+        }
+        if (code[i].op != IR_DEFVAR || strncmp(code[i].args[0].text, "LF@", 3) != 0)
+            size++; // the declarations move to the caller's header
+    }
+    return size;
+}
+
+/**
+ * Checks whether the results of a call cannot be read after the instruction.
+ */
+static bool ends_call(ir_opcode op) {
+    return op == IR_CREATEFRAME || op == IR_CALL || op == IR_LABEL || op == IR_JUMP || op == IR_JUMPIFEQ
+        || op == IR_JUMPIFNEQ || op == IR_JUMPIFEQS || op == IR_JUMPIFNEQS || op == IR_PUSHFRAME
+        || op == IR_POPFRAME || op == IR_RETURN || op == IR_EXIT;
+}
+
+/**
+ * Renames an operand of the inlined code for the caller f, the local variables get their
+ * scope index increased by base and the labels defined in the callee get their new names.
+ * The other operands are copied to f, so nothing refers to the code of the callee.
+ */
+static bool rename_operand(ir_func *f, ir_operand *o, long base, symtable_ptr labels, const ir_operand *args) {
+    stnode_ptr label = o->kind == IR_LABEL_REF ? symtable_search(labels, o->text) : NULL;
+    if (label != NULL) {
+        o->text = label->data;
+    }
+    else if (is_param(o->text)) {
+        *o = args[strtoul(o->text + 4, NULL, 10)];
+    }
+    else if (strncmp(o->text, "LF@", 3) == 0) {
+        int len;
+        long scope = scope_of(o->text, &len);
+        *o = ir_operand_fmt(&f->text, IR_VAR, "LF@%.*s%%%ld", len, o->text + 3, scope + base);
+    }
+    else {
+        *o = ir_operand_fmt(&f->text, o->kind, "%s", o->text);
+    }
+    return o->text != NULL;
+}
+
+/**
+ * Appends the code of the callee in place of its call, its declarations go to decls.
+ * scope is the last scope index used in f, the inlined variables are numbered after it.
+ * Its labels are numbered by the inlined labels of f, so they do not grow when inlined
+ * again. The callee is freed once its last call is replaced.
+ */
+static bool inline_call(graph_t *g, ir_func *f, unsigned int callee, ir_operand *args, long *scope, ir_list *out, ir_list *decls) {
+    ir_func *func = g->funcs[callee];
+    long base = *scope + 1;
+    symtable_ptr labels;
+    symtable_init(&labels);
+    bool ok = true;
+
+    // the entry label, PUSHFRAME, POPFRAME and RETURN are left out
+    for (unsigned int i = 2; ok && i < func->code.count - 2; i++) {
+        ir_instr *instr = &func->code.items[i];
+        if (instr->op != IR_LABEL)
+            continue;
+        bool error = false;
+        stnode_ptr node = symtable_insert(&labels, instr->args[0].text, &error);
+        ir_operand label = ir_operand_fmt(&f->text, IR_LABEL_REF, "$%s$inline$%lu", f->name, f->inlined++);
+        ok = node != NULL && label.text != NULL;
+        if (ok)
+            node->data = (void*)label.text;
+    }
+    for (unsigned int i = 2; ok && i < func->code.count - 2; i++) {
+        ir_instr instr = func->code.items[i];
+        for (unsigned int j = 0; ok && j < instr.nargs; j++)
+            ok = rename_operand(f, &instr.args[j], base, labels, args);
+        bool declaration = instr.op == IR_DEFVAR && strncmp(instr.args[0].text, "LF@", 3) == 0;
+        ok = ok && ir_add(declaration ? decls : out, &instr);
+    }
+    symtable_dispose(&labels, keep);
+    if (!ok)
+        return false;
+
+    long callee_scope = base + max_scope(&func->code);
+    if (callee_scope > *scope)
+        *scope = callee_scope;
+
+    count_calls(g, &func->code, true); // the calls of the callee are copied
+    if (--g->sites[callee] == 0) {
+        count_calls(g, &func->code, false);
+        ir_free(&func->code);
+        arena_free(&func->text);
+        ir_init(&func->code);
+        arena_init(&func->text);
+    }
+    return true;
+}
+
+static bool inline_calls(graph_t *g, unsigned int f) {
+    ir_func *func = g->funcs[f];
+    ir_list *code = &func->code;
+    ir_list out, decls;
+    ir_init(&out);
+    ir_init(&decls);
+    long scope = max_scope(code);
+    long results = -1; // scope index of the results of the last inlined call, -1 once they are not read
+    int header = -1; // index of PUSHFRAME in out
+    bool ok = true, inlined = false;
+
+    for (unsigned int i = 0; ok && i < code->count; i++) {
+        ir_instr instr = code->items[i];
+        if (instr.op == IR_CREATEFRAME && header >= 0) {
+            ir_operand args[MAX_ARGS];
+            unsigned int nargs;
+            int p = ir_call(code, i, args, MAX_ARGS, &nargs);
+            int callee = p >= 0 ? find(g, code->items[p].args[0].text) : -1;
+            if (callee >= 0 && g->component[callee] != g->component[f] && !g->recursive[callee]) {
+                unsigned int params;
+                int size = cost(g->funcs[callee], &params);
+                if (size >= 0 && params <= nargs
+                    && (size <= INLINE_SIZE || (g->sites[callee] == 1 && size <= INLINE_ONCE_SIZE))) {
+                    results = scope + 1;
+                    ok = inline_call(g, func, callee, args, &scope, &out, &decls);
+                    inlined = true;
+                    i = p;
+                    continue;
+                }
+            }
+        }
+
+        if (ends_call(instr.op))
+            results = -1;
+        for (unsigned int j = 0; results >= 0 && j < instr.nargs; j++) {
+            // the results are in the variables of the inlined code
+            if (strncmp(instr.args[j].text, "TF@%retval", 10) == 0) {
+                instr.args[j] = ir_operand_fmt(&func->text, IR_VAR, "LF@%s%%%ld", instr.args[j].text + 3, results);
+                ok = ok && instr.args[j].text != NULL;
+            }
+        }
+        if (instr.op == IR_PUSHFRAME && header < 0)
+            header = out.count;
+        ok = ok && ir_add(&out, &instr);
+    }
+
+    // LABEL, PUSHFRAME, the inlined declarations and the code, the compact code is kept if nothing was inlined
+    ir_list merged;
+    ir_init(&merged);
+    for (unsigned int i = 0; ok && inlined && i < out.count; i++) {
+        ok = ir_add(&merged, &out.items[i]) && ((int)i != header || ir_append(&merged, &decls));
+    }
+    if (ok && inlined)
+        ir_swap(code, &merged);
+    ir_free(&merged);
+    ir_free(&out);
+    ir_free(&decls);
+    return ok;
+}
+
+/**
+ * Marks main and the functions that are still called from a marked one.
+ */
+static bool mark_called(graph_t *g) {
+    unsigned int *queue = malloc((g->count + 1) * sizeof(unsigned int));
+    if (queue == NULL)
+        return false;
+
+    unsigned int head = 0, tail = 0;
+    for (unsigned int f = 0; f < g->count; f++) {
+        g->funcs[f]->called = strcmp(g->funcs[f]->name, "main") == 0;
+        if (g->funcs[f]->called)
+            queue[tail++] = f;
+    }
+    while (head < tail) {
+        ir_list *code = &g->funcs[queue[head++]]->code;
+        for (unsigned int i = 0; i < code->count; i++) {
+            int callee = code->items[i].op == IR_CALL ? find(g, code->items[i].args[0].text) : -1;
+            if (callee >= 0 && !g->funcs[callee]->called) {
+                g->funcs[callee]->called = true;
+                queue[tail++] = callee;
+            }
+        }
+    }
+    free(queue);
+    return true;
+}
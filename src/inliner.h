@@ -0,0 +1,46 @@
+/**
+ * Project name: Imperative language IFJ20 compiler implementation
+ * Název projektu: Implementace překladače imperativního jazyka IFJ20
+ *
+ * @brief Function inliner interface
+ *
+ * @author Daniel Moudrý <xmoudr01 at stud.fit.vutbr.cz>
+ */
+
+#ifndef _INLINER_H
+#define _INLINER_H
+
+#include "ir.h"
+
+#define INLINE_SIZE 32 // Functions of at most this many instructions are inlined at every call
+#define INLINE_ONCE_SIZE 256 // Functions called once are inlined up to this many instructions
+
+/**
+ * @struct Optimized code of a user function
+ */
+typedef struct
+{
+    const char *name; // Function name, its entry label is $name
+    ir_list code; // Whole function from LABEL $name to RETURN
+    arena text; // Operand texts of the code
+    unsigned long inlined; // Number of labels inlined into the function, numbers them
+    bool called; // Still called from main once the calls are inlined
+} ir_func;
+
+/**
+ * @brief Replaces calls of small non-recursive functions by their code
+ *
+ * Callees are inlined before their callers, so a caller sees their final size. A function
+ * is inlined if it has at most INLINE_SIZE instructions, or INLINE_ONCE_SIZE if it is
+ * called only once. Functions calling themselves, directly or through other functions,
+ * are never inlined. Variables of an inlined call get the scope index of the caller's
+ * last scope increased by their own, its labels become $caller$inline$n, the parameters
+ * are replaced by the arguments and the declarations join those of the caller. The code
+ * of a function is freed once its last call is inlined.
+ *
+ * @param funcs The functions reachable from main, including main
+ * @return false if there was an error
+ */
+bool inliner(ir_func **funcs, unsigned int count);
+
+#endif
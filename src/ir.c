@@ -0,0 +1,264 @@
+/**
+ * Project name: Imperative language IFJ20 compiler implementation
+ * Název projektu: Implementace překladače imperativního jazyka IFJ20
+ *
+ * @brief Instruction list implementation
+ *
+ * @author Petr Kabelka <xkabel09 at stud.fit.vutbr.cz>
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "ir.h"
+
+static const char *opcode_names[IR_OPCODE_COUNT] = {
+    "MOVE", "CREATEFRAME", "PUSHFRAME", "POPFRAME", "DEFVAR", "CALL", "RETURN",
+    "PUSHS", "POPS", "CLEARS",
+    "ADD", "SUB", "MUL", "DIV", "IDIV", "ADDS", "SUBS", "MULS", "DIVS", "IDIVS",
+    "LT", "GT", "EQ", "LTS", "GTS", "EQS", "AND", "OR", "NOT", "ANDS", "ORS", "NOTS",
+    "INT2FLOAT", "FLOAT2INT", "INT2CHAR", "STRI2INT", "INT2FLOATS", "FLOAT2INTS", "INT2CHARS", "STRI2INTS",
+    "READ", "WRITE", "CONCAT", "STRLEN", "GETCHAR", "SETCHAR", "TYPE",
+    "LABEL", "JUMP", "JUMPIFEQ", "JUMPIFNEQ", "JUMPIFEQS", "JUMPIFNEQS", "EXIT", "BREAK", "DPRINT"
+};
+
+static const unsigned char opcode_arity[IR_OPCODE_COUNT] = {
+    2, 0, 0, 0, 1, 1, 0,
+    1, 1, 0,
+    3, 3, 3, 3, 3, 0, 0, 0, 0, 0,
+    3, 3, 3, 0, 0, 0, 3, 3, 2, 0, 0, 0,
+    2, 2, 2, 3, 0, 0, 0, 0,
+    2, 1, 3, 2, 3, 3, 2,
+    1, 1, 3, 3, 1, 1, 1, 0, 1
+};
+
+void ir_init(ir_list *l)
+{
+    l->items = NULL;
+    l->count = 0;
+    l->size = 0;
+}
+
+void ir_clear(ir_list *l)
+{
+    l->count = 0;
+}
+
+void ir_free(ir_list *l)
+{
+    free(l->items);
+    ir_init(l);
+}
+
+bool ir_add(ir_list *l, ir_instr *instr)
+{
+    if (l->count == l->size)
+    {
+        unsigned int size = l->size == 0 ? 256 : 2 * l->size;
+        ir_instr *items = realloc(l->items, size * sizeof(ir_instr));
+        if (items == NULL)
+        {
+            return false;
+        }
+        l->items = items;
+        l->size = size;
+    }
+    l->items[l->count++] = *instr;
+    return true;
+}
+
+bool ir_emit(ir_list *l, ir_opcode op, ...)
+{
+    ir_instr instr;
+    instr.op = op;
+    instr.nargs = opcode_arity[op];
+
+    va_list args;
+    va_start(args, op);
+    for (unsigned int i = 0; i < instr.nargs; i++)
+    {
+        instr.args[i] = va_arg(args, ir_operand);
+    }
+    va_end(args);
+
+    for (unsigned int i = 0; i < instr.nargs; i++)
+    {
+        if (instr.args[i].text == NULL)
+        {
+            return false;
+        }
+    }
+    return ir_add(l, &instr);
+}
+
+bool ir_append(ir_list *dst, ir_list *src)
+{
+    for (unsigned int i = 0; i < src->count; i++)
+    {
+        if (!ir_add(dst, &src->items[i]))
+        {
+            return false;
+        }
+    }
+    ir_clear(src);
+    return true;
+}
+
+void ir_swap(ir_list *l1, ir_list *l2)
+{
+    ir_list tmp = *l1;
+    *l1 = *l2;
+    *l2 = tmp;
+}
+
+bool ir_copy(ir_list *dst, ir_list *src, arena *text)
+{
+    size_t len = 0;
+    for (unsigned int i = 0; i < src->count; i++)
+    {
+        for (unsigned int j = 0; j < src->items[i].nargs; j++)
+            len += strlen(src->items[i].args[j].text) + 1;
+    }
+
+    char *chars = arena_alloc_exact(text, len + 1);
+    ir_instr *items = src->count == 0 ? NULL : malloc(src->count * sizeof(ir_instr));
+    if (chars == NULL || (src->count > 0 && items == NULL))
+    {
+        free(items);
+        return false;
+    }
+
+    for (unsigned int i = 0; i < src->count; i++)
+    {
+        items[i] = src->items[i];
+        for (unsigned int j = 0; j < items[i].nargs; j++)
+        {
+            size_t size = strlen(items[i].args[j].text) + 1;
+            memcpy(chars, items[i].args[j].text, size);
+            items[i].args[j].text = chars;
+            chars += size;
+        }
+    }
+    free(dst->items);
+    dst->items = items;
+    dst->count = dst->size = src->count;
+    return true;
+}
+
+ir_operand ir_operand_fmt(arena *a, ir_operand_kind kind, const char *fmt, ...)
+{
+    ir_operand operand;
+    operand.kind = kind;
+
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(NULL, 0, fmt, args);
+    va_end(args);
+
+    char *text = len < 0 ? NULL : arena_alloc(a, len + 1);
+    if (text != NULL)
+    {
+        va_start(args, fmt);
+        vsnprintf(text, len + 1, fmt, args);
+        va_end(args);
+    }
+    operand.text = text;
+    return operand;
+}
+
+bool ir_is_unconditional(ir_opcode op)
+{
+    return op == IR_JUMP || op == IR_RETURN || op == IR_EXIT;
+}
+
+int ir_blocks(ir_list *l, ir_block **blocks)
+{
+    // there are at most as many blocks as instructions
+    *blocks = malloc((l->count + 1) * sizeof(ir_block));
+    if (*blocks == NULL)
+    {
+        return -1;
+    }
+
+    int count = 0;
+    unsigned int start = 0;
+    for (unsigned int i = 0; i < l->count; i++)
+    {
+        ir_opcode op = l->items[i].op;
+        if (op == IR_LABEL && i > start)
+        {
+            (*blocks)[count].start = start;
+            (*blocks)[count++].end = i;
+            start = i;
+        }
+        if (op == IR_JUMP || op == IR_JUMPIFEQ || op == IR_JUMPIFNEQ || op == IR_JUMPIFEQS
+            || op == IR_JUMPIFNEQS || op == IR_RETURN || op == IR_EXIT)
+        {
+            (*blocks)[count].start = start;
+            (*blocks)[count++].end = i + 1;
+            start = i + 1;
+        }
+    }
+    if (start < l->count)
+    {
+        (*blocks)[count].start = start;
+        (*blocks)[count++].end = l->count;
+    }
+    return count;
+}
+
+int ir_call(ir_list *l, unsigned int i, ir_operand *args, unsigned int max, unsigned int *nargs)
+{
+    *nargs = 0;
+    if (l->items[i].op != IR_CREATEFRAME)
+    {
+        return -1;
+    }
+
+    // DEFVAR TF@%n and MOVE TF@%n arg for every argument
+    char name[32];
+    unsigned int p = i + 1;
+    while (p + 1 < l->count && l->items[p].op == IR_DEFVAR && l->items[p + 1].op == IR_MOVE)
+    {
+        sprintf(name, "TF@%%%u", *nargs);
+        if (strcmp(l->items[p].args[0].text, name) != 0 || strcmp(l->items[p + 1].args[0].text, name) != 0)
+        {
+            return -1;
+        }
+        if (*nargs == max)
+        {
+            return -1;
+        }
+        args[(*nargs)++] = l->items[p + 1].args[1];
+        p += 2;
+    }
+    return p < l->count && l->items[p].op == IR_CALL ? (int)p : -1;
+}
+
+bool ir_write(ir_list *l, rope *r)
+{
+    for (unsigned int i = 0; i < l->count; i++)
+    {
+        ir_instr *instr = &l->items[i];
+        if (!rope_add_const(r, opcode_names[instr->op]))
+        {
+            return false;
+        }
+        for (unsigned int j = 0; j < instr->nargs; j++)
+        {
+            if (!rope_add_var(r, " ", instr->args[j].text, NULL))
+            {
+                return false;
+            }
+        }
+        if (!rope_add_const(r, "\n"))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ir_operand_equal(const ir_operand *a, const ir_operand *b)
+{
+    return a->kind == b->kind && strcmp(a->text, b->text) == 0;
+}
@@ -0,0 +1,220 @@
+/**
+ * Project name: Imperative language IFJ20 compiler implementation
+ * Název projektu: Implementace překladače imperativního jazyka IFJ20
+ *
+ * @brief Instruction list interface, the code generator builds it and passes rewrite it
+ *
+ * Instructions are printed as IFJcode20 text only when a function is complete.
+ *
+ * @author Petr Kabelka <xkabel09 at stud.fit.vutbr.cz>
+ */
+
+#ifndef _IR_H
+#define _IR_H
+
+#include <stdbool.h>
+#include <stdarg.h>
+#include "arena.h"
+#include "rope.h"
+
+/**
+ * @enum IFJcode20 instructions
+ */
+typedef enum
+{
+    IR_MOVE,
+    IR_CREATEFRAME,
+    IR_PUSHFRAME,
+    IR_POPFRAME,
+    IR_DEFVAR,
+    IR_CALL,
+    IR_RETURN,
+    IR_PUSHS,
+    IR_POPS,
+    IR_CLEARS,
+    IR_ADD,
+    IR_SUB,
+    IR_MUL,
+    IR_DIV,
+    IR_IDIV,
+    IR_ADDS,
+    IR_SUBS,
+    IR_MULS,
+    IR_DIVS,
+    IR_IDIVS,
+    IR_LT,
+    IR_GT,
+    IR_EQ,
+    IR_LTS,
+    IR_GTS,
+    IR_EQS,
+    IR_AND,
+    IR_OR,
+    IR_NOT,
+    IR_ANDS,
+    IR_ORS,
+    IR_NOTS,
+    IR_INT2FLOAT,
+    IR_FLOAT2INT,
+    IR_INT2CHAR,
+    IR_STRI2INT,
+    IR_INT2FLOATS,
+    IR_FLOAT2INTS,
+    IR_INT2CHARS,
+    IR_STRI2INTS,
+    IR_READ,
+    IR_WRITE,
+    IR_CONCAT,
+    IR_STRLEN,
+    IR_GETCHAR,
+    IR_SETCHAR,
+    IR_TYPE,
+    IR_LABEL,
+    IR_JUMP,
+    IR_JUMPIFEQ,
+    IR_JUMPIFNEQ,
+    IR_JUMPIFEQS,
+    IR_JUMPIFNEQS,
+    IR_EXIT,
+    IR_BREAK,
+    IR_DPRINT,
+    IR_OPCODE_COUNT
+} ir_opcode;
+
+/**
+ * @enum Kinds of instruction operands
+ */
+typedef enum
+{
+    IR_VAR, // GF@, LF@ or TF@ variable
+    IR_CONST, // int@, float@, string@, bool@ or nil@ constant
+    IR_LABEL_REF, // Jump target
+    IR_TYPE_NAME // Type operand of READ
+} ir_operand_kind;
+
+/**
+ * @struct Instruction operand
+ */
+typedef struct
+{
+    ir_operand_kind kind;
+    const char *text; // Operand as written in the code, e.g. LF@a%1 or int@5, NULL if its allocation failed
+} ir_operand;
+
+/**
+ * @struct Instruction
+ */
+typedef struct
+{
+    ir_opcode op;
+    unsigned int nargs;
+    ir_operand args[3];
+} ir_instr;
+
+/**
+ * @struct Instruction list
+ */
+typedef struct
+{
+    ir_instr *items;
+    unsigned int count;
+    unsigned int size; // Capacity of items
+} ir_list;
+
+/**
+ * @struct Basic block, instructions [start, end) that run from the first to the last
+ */
+typedef struct
+{
+    unsigned int start;
+    unsigned int end;
+} ir_block;
+
+/**
+ * @brief Initializes an empty instruction list
+ */
+void ir_init(ir_list *l);
+
+/**
+ * @brief Removes all instructions, the array is kept for reuse
+ */
+void ir_clear(ir_list *l);
+
+/**
+ * @brief Frees the instruction list
+ */
+void ir_free(ir_list *l);
+
+/**
+ * @brief Appends an instruction
+ * @return True upon successful append
+ */
+bool ir_add(ir_list *l, ir_instr *instr);
+
+/**
+ * @brief Appends an instruction with as many operands as the opcode takes
+ * @param ... ir_operand values
+ * @return False if an operand is NULL or if there was an error
+ */
+bool ir_emit(ir_list *l, ir_opcode op, ...);
+
+/**
+ * @brief Moves all instructions of src to the end of dst, src is left empty
+ * @return True upon successful append
+ */
+bool ir_append(ir_list *dst, ir_list *src);
+
+/**
+ * @brief Swaps the two instruction lists
+ */
+void ir_swap(ir_list *l1, ir_list *l2);
+
+/**
+ * @brief Replaces dst by a copy of src without unused capacity, the operand texts are
+ * copied to one block of text
+ * @return False if there was an error, dst is unchanged then
+ */
+bool ir_copy(ir_list *dst, ir_list *src, arena *text);
+
+/**
+ * @brief Creates an operand from printf-like format
+ * @param a Arena the text is allocated from
+ * @return The operand, its text is NULL if the allocation failed
+ */
+ir_operand ir_operand_fmt(arena *a, ir_operand_kind kind, const char *fmt, ...);
+
+/**
+ * @brief Splits the list into basic blocks, a block starts at a label or after a jump
+ * @param blocks Set to a malloc allocated array of the blocks
+ * @return Number of blocks, -1 if the allocation failed
+ */
+int ir_blocks(ir_list *l, ir_block **blocks);
+
+/**
+ * @brief Checks whether the instruction never continues with the next one
+ */
+bool ir_is_unconditional(ir_opcode op);
+
+/**
+ * @brief Reads the call that starts with CREATEFRAME at index i
+ *
+ * The generator moves every argument into TF@%n before CALL, the moved operands are stored into args.
+ *
+ * @param max Capacity of args
+ * @param nargs Set to the number of arguments
+ * @return Index of the CALL, -1 if the code is not a call with at most max arguments
+ */
+int ir_call(ir_list *l, unsigned int i, ir_operand *args, unsigned int max, unsigned int *nargs);
+
+/**
+ * @brief Appends the instructions to the rope as IFJcode20 text
+ * @return True upon successful append
+ */
+bool ir_write(ir_list *l, rope *r);
+
+/**
+ * @brief Checks whether two operands are the same variable or constant
+ */
+bool ir_operand_equal(const ir_operand *a, const ir_operand *b);
+
+#endif
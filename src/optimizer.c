@@ -7,20 +7,27 @@
  * @author Daniel Moudrý <xmoudr01 at stud.fit.vutbr.cz>
  */
 
+#include <limits.h>
 #include "optimizer.h"
 #include "error.h"
-#include "dll.h"
 
-static int copy_value(dll_node_t *dst, dll_node_t *src);
-static dll_node_t* free_nodes(dll_node_t *operand_one, dll_node_t *operand_two, dll_node_t *current_node);
+static bool equals(symbol_t *symbol, long value);
+static int reassociate(data_t *data, symbol_vector_t *list, unsigned int *out, symbol_t *symbol, symbol_type type);
+static bool associative(symbol_type type, o_type operator);
+static int combine(data_t *data, symbol_t *dst, symbol_t *constant, bool multiply, bool negate);
+static string *concat(data_t *data, string *str_one, string *str_two);
+static int simplify(symbol_vector_t *list, unsigned int *out, symbol_t *symbol, symbol_type type);
+static unsigned int operand_start(symbol_vector_t *list, unsigned int end);
+static bool can_fail(symbol_vector_t *list, unsigned int start, unsigned int end);
+static bool relation(symbol_t *operand_one, symbol_t *operand_two, o_type operator);
 
-int optimize(data_t *data, dll_t *list) {
-    dll_node_t *operand_one;
-    dll_node_t *operand_two;
+int optimize(data_t *data, symbol_vector_t *list) {
+    symbol_t *operand_one;
+    symbol_t *operand_two;
     symbol_t *symbol;
     o_type operator;
 
-    symbol_type type;
+    symbol_type type = SYM_STOP; // no operand has this type
     switch (data->current_type) {
         case 'i':
             type = SYM_INT;
@@ -35,237 +42,411 @@ int optimize(data_t *data, dll_t *list) {
             break;
     }
 
-
-    dll_node_t *node = list->first;
-    while (node != NULL) {
-        symbol = (symbol_t*)node->data;
+    // The list is reduced in place, items[0..out) is the already optimized part
+    // and its last two items are the operands of the next operator.
+    unsigned int out = 0;
+    for (unsigned int i = 0; i < list->count; i++) {
+        symbol = &list->items[i];
         if (symbol->sym_type == SYM_OPERATOR) {
-            operator = *((o_type*)(symbol->data));
-            if (operator == S_EQ || operator == S_NEQ || operator == S_GT || operator == S_GTE || operator == S_LT || operator == S_LTE) return 0;
-            operand_two = node->prev;
-            operand_one = operand_two->prev;
+            operator = symbol->data.op;
+            operand_two = &list->items[out - 1];
+            operand_one = &list->items[out - 2];
 
             // constant reduction
-            if (((symbol_t*)operand_one->data)->sym_type == type && ((symbol_t*)operand_two->data)->sym_type == type) {
-                if (type == SYM_INT || type == SYM_FLOAT64) {
-                    if (type == SYM_INT) {
-                        long *long_var_data = malloc(sizeof(long));
-                        if (long_var_data == NULL) return ERR_INTERNAL;
-                        switch (operator) {
-                            case S_ADD:
-                                *long_var_data = *((long*)((symbol_t*)operand_one->data)->data) + *((long*)((symbol_t*)operand_two->data)->data);
-                                break;
-                            case S_SUB:
-                                *long_var_data = *((long*)((symbol_t*)operand_one->data)->data) - *((long*)((symbol_t*)operand_two->data)->data);
-                                break;
-                            case S_MUL:
-                                *long_var_data = *((long*)((symbol_t*)operand_one->data)->data) * *((long*)((symbol_t*)operand_two->data)->data);
-                                break;
-                            case S_DIV:
-                                // zero division check
-                                if (*((long*)((symbol_t*)operand_two->data)->data) == 0)
-                                {
-                                    free(long_var_data);
-                                    return ERR_ZERO_DIVISION;
-                                }
-                                *long_var_data = *((long*)((symbol_t*)operand_one->data)->data) / *((long*)((symbol_t*)operand_two->data)->data);
-                                break;
-                            default:
-                                break;
-                        }
-                        ((symbol_t*)operand_one->data)->sym_type = SYM_INT;
-                        free(((symbol_t*)operand_one->data)->data);
-                        ((symbol_t*)operand_one->data)->data = long_var_data;
+            if (operand_one->sym_type == type && operand_two->sym_type == type) {
+                if (operator == S_EQ || operator == S_NEQ || operator == S_GT || operator == S_GTE || operator == S_LT || operator == S_LTE) {
+                    // the result is a compile-time boolean
+                    operand_one->data.bool_val = relation(operand_one, operand_two, operator);
+                    operand_one->sym_type = SYM_BOOL;
+                    out--;
+                    continue;
+                }
+                else if (operator == S_DIV && operand_two->propagated && equals(operand_two, 0)) {
+                    // the zero comes from a variable, the division may never run so it is checked at runtime
+                }
+                else if (type == SYM_INT) {
+                    operand_one->propagated = operand_one->propagated || operand_two->propagated;
+                    switch (operator) {
+                        case S_ADD:
+                            operand_one->data.int_val += operand_two->data.int_val;
+                            break;
+                        case S_SUB:
+                            operand_one->data.int_val -= operand_two->data.int_val;
+                            break;
+                        case S_MUL:
+                            operand_one->data.int_val *= operand_two->data.int_val;
+                            break;
+                        case S_DIV:
+                            // zero division check
+                            if (operand_two->data.int_val == 0)
+                                return ERR_ZERO_DIVISION;
+                            operand_one->data.int_val /= operand_two->data.int_val;
+                            break;
+                        default:
+                            break;
                     }
-                    else if (type == SYM_FLOAT64) {
-                        double *float_var_data = malloc(sizeof(double));
-                        if (float_var_data == NULL) return ERR_INTERNAL;
-                        switch (operator) {
-                            case S_ADD:
-                                *float_var_data = *((double*)((symbol_t*)operand_one->data)->data) + *((double*)((symbol_t*)operand_two->data)->data);
-                                break;
-                            case S_SUB:
-                                *float_var_data = *((double*)((symbol_t*)operand_one->data)->data) - *((double*)((symbol_t*)operand_two->data)->data);
-                                break;
-                            case S_MUL:
-                                *float_var_data = *((double*)((symbol_t*)operand_one->data)->data) * *((double*)((symbol_t*)operand_two->data)->data);
-                                break;
-                            case S_DIV:
-                                // zero division check
-                                if (*((double*)((symbol_t*)operand_two->data)->data) == 0)
-                                {
-                                    free(float_var_data);
-                                    return ERR_ZERO_DIVISION;
-                                }
-                                *float_var_data = *((double*)((symbol_t*)operand_one->data)->data) / *((double*)((symbol_t*)operand_two->data)->data);
-                                break;
-                            default:
-                                break;
-                        }
-                        ((symbol_t*)operand_one->data)->sym_type = SYM_FLOAT64;
-                        free(((symbol_t*)operand_one->data)->data);
-                        ((symbol_t*)operand_one->data)->data = float_var_data;
+                    out--;
+                    continue;
+                }
+                else if (type == SYM_FLOAT64) {
+                    operand_one->propagated = operand_one->propagated || operand_two->propagated;
+                    switch (operator) {
+                        case S_ADD:
+                            operand_one->data.float64_val += operand_two->data.float64_val;
+                            break;
+                        case S_SUB:
+                            operand_one->data.float64_val -= operand_two->data.float64_val;
+                            break;
+                        case S_MUL:
+                            operand_one->data.float64_val *= operand_two->data.float64_val;
+                            break;
+                        case S_DIV:
+                            // zero division check
+                            if (operand_two->data.float64_val == 0)
+                                return ERR_ZERO_DIVISION;
+                            operand_one->data.float64_val /= operand_two->data.float64_val;
+                            break;
+                        default:
+                            break;
                     }
-
-                    node = free_nodes(operand_one, operand_two, node);
+                    out--;
                     continue;
                 }
                 else if (type == SYM_STRING) {
                     if (operator == S_ADD) {
-                        string *string_var_data = malloc(sizeof(string));
-                        if (string_var_data == NULL) return ERR_INTERNAL;
-                        str_init(string_var_data);
-
-                        str_add_const(string_var_data, ((string*)((symbol_t*)operand_one->data)->data)->str);
-                        str_add_const(string_var_data, ((string*)((symbol_t*)operand_two->data)->data)->str);
-                        ((symbol_t*)operand_one->data)->sym_type = SYM_STRING;
-                        str_free((string*)(((symbol_t*)operand_one->data)->data));
-                        free(((symbol_t*)operand_one->data)->data);
-                        ((symbol_t*)operand_one->data)->data = string_var_data;
-
-                        node = free_nodes(operand_one, operand_two, node);
+                        operand_one->data.str = concat(data, operand_one->data.str, operand_two->data.str);
+                        if (operand_one->data.str == NULL) return ERR_INTERNAL;
+                        out--;
                         continue;
                     }
                 }
             }
-            // optimize variables in certain situations
-            else {
-                if (((symbol_t*)operand_one->data)->sym_type == type && ((symbol_t*)operand_two->data)->sym_type == SYM_VAR) {
-                    if (type == SYM_INT) {
-                        if (*((long*)((symbol_t*)operand_one->data)->data) == 0) {
-                            if (operator == S_MUL) { // 0 * x = 0
-                                node = free_nodes(operand_one, operand_two, node);
-                                continue;
-                            }
-                            else if (operator == S_ADD) { // 0 + x = x
-                                if (copy_value(operand_one, operand_two) == ERR_INTERNAL) return ERR_INTERNAL;
-                                node = free_nodes(operand_one, operand_two, node);
-                                continue;
-                            }
-                        }
-                        else if (*((long*)((symbol_t*)operand_one->data)->data) == 1) {
-                            if (operator == S_MUL) { // 1 * x = x
-                                if (copy_value(operand_one, operand_two) == ERR_INTERNAL) return ERR_INTERNAL;
-                                node = free_nodes(operand_one, operand_two, node);
-                                continue;
-                            }
-                        }
-                    }
-                    else if (type == SYM_FLOAT64) {
-                        if (*((double*)((symbol_t*)operand_one->data)->data) == 0) {
-                            if (operator == S_MUL) { // 0 * x = 0
-                                node = free_nodes(operand_one, operand_two, node);
-                                continue;
-                            }
-                            else if (operator == S_ADD) { // 0 + x = x
-                                if (copy_value(operand_one, operand_two) == ERR_INTERNAL) return ERR_INTERNAL;
-                                node = free_nodes(operand_one, operand_two, node);
-                                continue;
-                            }
-                        }
-                        else if (*((double*)((symbol_t*)operand_one->data)->data) == 1) {
-                            if (operator == S_MUL) { // 1 * x = x
-                                if (copy_value(operand_one, operand_two) == ERR_INTERNAL) return ERR_INTERNAL;
-                                node = free_nodes(operand_one, operand_two, node);
-                                continue;
-                            }
-                        }
-                    }
-                }
-                else if (((symbol_t*)operand_two->data)->sym_type == type && ((symbol_t*)operand_one->data)->sym_type == SYM_VAR) {
-                    if (type == SYM_INT) {
-                        if (*((long*)((symbol_t*)operand_two->data)->data) == 0) {
-                            if (operator == S_MUL) { // x * 0 = 0
-                                if (copy_value(operand_one, operand_two) == ERR_INTERNAL) return ERR_INTERNAL;
-                                node = free_nodes(operand_one, operand_two, node);
-                                continue;
-                            }
-                            else if (operator == S_ADD || operator == S_SUB) { // x + 0 = x or x - 0 = x
-                                node = free_nodes(operand_one, operand_two, node);
-                                continue;
-                            }
-                            else if (operator == S_DIV){
-                                return ERR_ZERO_DIVISION;
-                            }
-                        }
-                        else if (*((long*)((symbol_t*)operand_two->data)->data) == 1) {
-                            if (operator == S_MUL || operator == S_DIV) { // x * 1 = x or x / 1 = x
-                                node = free_nodes(operand_one, operand_two, node);
-                                continue;
-                            }
-                        }
-                    }
-                    else if (type == SYM_FLOAT64) {
-                        if (*((double*)((symbol_t*)operand_two->data)->data) == 0) {
-                            if (operator == S_MUL) {
-                                if(copy_value(operand_one, operand_two) == ERR_INTERNAL) return ERR_INTERNAL;
-                                node = free_nodes(operand_one, operand_two, node);
-                                continue;
-                            }
-                            else if (operator == S_ADD || operator == S_SUB) {
-                                node = free_nodes(operand_one, operand_two, node);
-                                continue;
-                            }
-                            else if (operator == S_DIV) {
-                                return ERR_ZERO_DIVISION;
-                            }
-                        }
-                        else if (*((double*)((symbol_t*)operand_two->data)->data) == 1) {
-                            if (operator == S_MUL || operator == S_DIV) { // x * 1 = x or x / 1 = x
-                                node = free_nodes(operand_one, operand_two, node);
-                                continue;
-                            }
-                        }
-                    }
-                }
+            // algebraic identities and cheaper operators
+            else if (type != SYM_STOP) {
+                int result = reassociate(data, list, &out, symbol, type);
+                if (result == 0)
+                    result = simplify(list, &out, symbol, type);
+                if (result < 0)
+                    continue;
+                if (result > 0)
+                    return result;
             }
         }
 
-        node = node->next;
+        list->items[out++] = *symbol;
     }
+    list->count = out;
 
     return 0;
 }
 
-static int copy_value(dll_node_t *dst, dll_node_t *src) {
-    switch (((symbol_t*)src->data)->sym_type) {
-        case SYM_INT: ;
-            long *long_var_data = malloc(sizeof(long));
-            if (long_var_data == NULL) return ERR_INTERNAL;
-            *long_var_data = *((long*)((symbol_t*)src->data)->data);
+static bool relation(symbol_t *operand_one, symbol_t *operand_two, o_type operator) {
+    if (operand_one->sym_type == SYM_FLOAT64) { // compared directly, NaN is not equal to anything
+        double a = operand_one->data.float64_val;
+        double b = operand_two->data.float64_val;
+        switch (operator) {
+            case S_EQ:
+                return a == b;
+            case S_NEQ:
+                return a != b;
+            case S_GT:
+                return a > b;
+            case S_LT:
+                return a < b;
+            case S_GTE:
+                return a > b || a == b; // like the generated GTS, EQS, ORS
+            default: // S_LTE
+                return a < b || a == b;
+        }
+    }
 
-            ((symbol_t*)dst->data)->sym_type = SYM_INT;
-            ((symbol_t*)dst->data)->data = long_var_data;
-            break;
+    int cmp;
+    if (operand_one->sym_type == SYM_INT) {
+        cmp = (operand_one->data.int_val > operand_two->data.int_val) - (operand_one->data.int_val < operand_two->data.int_val);
+    }
+    else { // strings compare bytewise like the interpreter does
+        string *str_one = operand_one->data.str;
+        string *str_two = operand_two->data.str;
+        cmp = memcmp(str_one->str, str_two->str, str_one->len < str_two->len ? str_one->len : str_two->len);
+        if (cmp == 0)
+            cmp = (str_one->len > str_two->len) - (str_one->len < str_two->len);
+    }
 
-        case SYM_FLOAT64: ;
-            double *float_var_data = malloc(sizeof(double));
-            if (float_var_data == NULL) return ERR_INTERNAL;
-            *float_var_data = *((double*)((symbol_t*)src->data)->data);
+    switch (operator) {
+        case S_EQ:
+            return cmp == 0;
+        case S_NEQ:
+            return cmp != 0;
+        case S_GT:
+            return cmp > 0;
+        case S_LT:
+            return cmp < 0;
+        case S_GTE:
+            return cmp >= 0;
+        default: // S_LTE
+            return cmp <= 0;
+    }
+}
 
-            ((symbol_t*)dst->data)->sym_type = SYM_FLOAT64;
-            ((symbol_t*)dst->data)->data = float_var_data;
-            break;
+/**
+ * Regroups chains of one associative operator so that their constants meet and fold,
+ * x + 1 + 2 is x + 3 and x * 2 * y * 3 is x * y * 6. Subtraction is taken as adding
+ * a negated operand. The operand that is not a constant may be any subexpression.
+ * Returns -1 when the operator was consumed, 0 when it is still to be added
+ * (possibly with changed operands) and an error code otherwise.
+ */
+static int reassociate(data_t *data, symbol_vector_t *list, unsigned int *out, symbol_t *symbol, symbol_type type) {
+    symbol_t outer = *symbol; // the symbol may get overwritten by the growing output
+    if (!associative(type, outer.data.op) || *out < 3)
+        return 0;
 
-        case SYM_VAR: ;
-            ((symbol_t*)dst->data)->sym_type = SYM_VAR;
-            free(((symbol_t*)dst->data)->data);
-            ((symbol_t*)dst->data)->data = ((symbol_t*)src->data)->data;
-            ((symbol_t*)src->data)->data = NULL;
+    bool multiply = outer.data.op == S_MUL;
+    bool subtract = outer.data.op == S_SUB;
+    symbol_t *items = list->items;
+    unsigned int two = operand_start(list, *out);
+    symbol_t *inner = &items[two - 1]; // top operator of operand one, if it is one
+    bool inner_chain = inner->sym_type == SYM_OPERATOR && associative(type, inner->data.op) && (inner->data.op == S_MUL) == multiply;
+
+    if (items[*out - 1].sym_type == type) {
+        symbol_t *constant = &items[*out - 1];
+        if (inner_chain && items[two - 2].sym_type == type) { // (x + c1) + c2 = x + (c1 + c2)
+            int result;
+            if (type == SYM_STRING)
+                result = combine(data, &items[two - 2], constant, false, false);
+            else { // (x - c1) - c2 = x - (c2 + c1), the outer operator stays
+                result = combine(data, constant, &items[two - 2], multiply, (inner->data.op == S_SUB) != subtract);
+                items[two - 2] = *constant;
+            }
+            if (result != 0)
+                return result;
+            *out -= 2;
+            return 0;
+        }
+        if (inner_chain && type != SYM_STRING) {
+            unsigned int one = operand_start(list, two);
+            // c1 has to be the whole left operand, not just the first item of a longer one
+            if (items[one].sym_type == type && operand_start(list, two - 1) == one + 1) { // (c1 + x) + c2 = (c1 + c2) + x
+                int result = combine(data, &items[one], constant, multiply, subtract);
+                if (result != 0)
+                    return result;
+                symbol_t inner_op = *inner;
+                *out -= 2;
+                result = simplify(list, out, &inner_op, type); // c1 + c2 may be 0
+                if (result > 0)
+                    return result;
+                if (result == 0)
+                    items[(*out)++] = inner_op;
+                return -1;
+            }
+        }
+        return 0;
+    }
 
+    if (type == SYM_STRING) // concatenation does not commute
+        return 0;
+
+    symbol_t *last = &items[*out - 1];
+    bool last_chain = last->sym_type == SYM_OPERATOR && associative(type, last->data.op) && (last->data.op == S_MUL) == multiply;
+    if (items[two - 1].sym_type == type) {
+        if (last_chain && items[*out - 2].sym_type == type) { // c2 - (x - c1) = (c2 + c1) - x
+            int result = combine(data, &items[two - 1], &items[*out - 2], multiply, (last->data.op == S_SUB) != subtract);
+            if (result != 0)
+                return result;
+            *out -= 2;
+        }
+        return 0;
+    }
+
+    if (inner_chain && items[two - 2].sym_type == type) { // (x + c1) + y = (x + y) + c1, the constant moves right to meet the next one
+        symbol_t constant = items[two - 2];
+        symbol_t inner_op = *inner;
+        memmove(&items[two - 2], &items[two], (*out - two) * sizeof(symbol_t));
+        items[*out - 2] = outer;
+        items[*out - 1] = constant;
+        items[*out] = inner_op;
+        (*out)++;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Checks whether chains of the operator may be regrouped, floats only when built
+ * with FLOAT_REASSOCIATION because the rounding changes.
+ */
+static bool associative(symbol_type type, o_type operator) {
+    if (type == SYM_STRING)
+        return operator == S_ADD;
+#ifndef FLOAT_REASSOCIATION
+    if (type == SYM_FLOAT64)
+        return false;
+#endif
+    return operator == S_ADD || operator == S_SUB || operator == S_MUL;
+}
+
+/**
+ * dst = dst * constant, dst + constant or dst - constant, strings are concatenated.
+ */
+static int combine(data_t *data, symbol_t *dst, symbol_t *constant, bool multiply, bool negate) {
+    dst->propagated = dst->propagated || constant->propagated;
+    switch (dst->sym_type) {
+        case SYM_INT:
+            if (multiply)
+                dst->data.int_val *= constant->data.int_val;
+            else if (negate)
+                dst->data.int_val -= constant->data.int_val;
+            else
+                dst->data.int_val += constant->data.int_val;
+            break;
+        case SYM_FLOAT64:
+            if (multiply)
+                dst->data.float64_val *= constant->data.float64_val;
+            else if (negate)
+                dst->data.float64_val -= constant->data.float64_val;
+            else
+                dst->data.float64_val += constant->data.float64_val;
+            break;
+        case SYM_STRING:
+            dst->data.str = concat(data, dst->data.str, constant->data.str);
+            if (dst->data.str == NULL)
+                return ERR_INTERNAL;
+            break;
         default:
             break;
     }
+    return 0;
+}
+
+/**
+ * Concatenates two constant strings in the function arena.
+ */
+static string *concat(data_t *data, string *str_one, string *str_two) {
+    string *result = arena_alloc(&data->func_arena, sizeof(string));
+    if (result == NULL) return NULL;
+    result->len = str_one->len + str_two->len;
+    result->mem_size = result->len + 1;
+    result->str = arena_alloc(&data->func_arena, result->mem_size);
+    if (result->str == NULL) return NULL;
 
+    memcpy(result->str, str_one->str, str_one->len);
+    memcpy(result->str + str_one->len, str_two->str, str_two->len + 1);
+    return result;
+}
+
+/**
+ * Applies the identities that hold for the expression type to the operator
+ * symbol whose operands end at items[*out - 1]. Either operand may be a whole
+ * subexpression, only one of them is a constant.
+ * Returns -1 when the operator was consumed, 0 when it is still to be added
+ * (possibly changed) and an error code otherwise.
+ */
+static int simplify(symbol_vector_t *list, unsigned int *out, symbol_t *symbol, symbol_type type) {
+    o_type operator = symbol->data.op;
+    unsigned int two = operand_start(list, *out);
+    unsigned int one = operand_start(list, two);
+    symbol_t *operand_two = &list->items[*out - 1];
+    symbol_t *operand_one = &list->items[two - 1];
+    bool const_two = operand_two->sym_type == type;
+    bool const_one = operand_one->sym_type == type && !const_two;
+
+    if (type == SYM_STRING) {
+        if (operator == S_ADD && const_two && operand_two->data.str->len == 0) { // s + "" = s
+            (*out)--;
+            return -1;
+        }
+        if (operator == S_ADD && const_one && operand_one->data.str->len == 0) { // "" + s = s
+            memmove(operand_one, operand_one + 1, (*out - two) * sizeof(symbol_t));
+            (*out)--;
+            return -1;
+        }
+        return 0;
+    }
+
+    if (const_two) {
+        if (operator == S_DIV && equals(operand_two, 0))
+            return operand_two->propagated ? 0 : ERR_ZERO_DIVISION;
+        if ((operator == S_ADD && type == SYM_INT) || operator == S_SUB) { // x + 0 = x, x - 0 = x (-0.0 + 0.0 is 0.0)
+            if (equals(operand_two, 0)) {
+                (*out)--;
+                return -1;
+            }
+        }
+        else if (operator == S_MUL || operator == S_DIV) { // x * 1 = x, x / 1 = x
+            if (equals(operand_two, 1)) {
+                (*out)--;
+                return -1;
+            }
+            if (operator == S_MUL && type == SYM_INT && equals(operand_two, 0) && !can_fail(list, one, two)) { // x * 0 = 0
+                list->items[one] = *operand_two;
+                *out = one + 1;
+                return -1;
+            }
+        }
+        else if (type == SYM_INT) { // x <= c is x < c + 1, x >= c is x > c - 1
+            if (operator == S_LTE && operand_two->data.int_val != LONG_MAX) {
+                operand_two->data.int_val++;
+                symbol->data.op = S_LT;
+            }
+            else if (operator == S_GTE && operand_two->data.int_val != LONG_MIN) {
+                operand_two->data.int_val--;
+                symbol->data.op = S_GT;
+            }
+        }
+    }
+    else if (const_one) {
+        if ((operator == S_ADD && type == SYM_INT && equals(operand_one, 0)) || (operator == S_MUL && equals(operand_one, 1))) { // 0 + x = x, 1 * x = x
+            memmove(operand_one, operand_one + 1, (*out - two) * sizeof(symbol_t));
+            (*out)--;
+            return -1;
+        }
+        if (operator == S_MUL && type == SYM_INT && equals(operand_one, 0) && !can_fail(list, two, *out)) { // 0 * x = 0
+            *out = two;
+            return -1;
+        }
+        if (type == SYM_INT) { // c <= x is c - 1 < x, c >= x is c + 1 > x
+            if (operator == S_LTE && operand_one->data.int_val != LONG_MIN) {
+                operand_one->data.int_val--;
+                symbol->data.op = S_LT;
+            }
+            else if (operator == S_GTE && operand_one->data.int_val != LONG_MAX) {
+                operand_one->data.int_val++;
+                symbol->data.op = S_GT;
+            }
+        }
+    }
     return 0;
 }
 
-static dll_node_t* free_nodes(dll_node_t *operand_one, dll_node_t *operand_two, dll_node_t *current_node) {
-    operand_one->next = current_node->next;
-    if(current_node->next != NULL) current_node->next->prev = operand_one;
-    free_symbol(((symbol_t*)operand_two->data));
-    free_symbol(((symbol_t*)current_node->data));
-    free(operand_two);
-    free(current_node);
-    return operand_one->next;
-}
\ No newline at end of file
+/**
+ * Returns the index where the operand ending at items[end - 1] starts.
+ */
+static unsigned int operand_start(symbol_vector_t *list, unsigned int end) {
+    unsigned int missing = 1; // operands still to be walked over
+    while (missing > 0) {
+        end--;
+        if (list->items[end].sym_type == SYM_OPERATOR)
+            missing++; // a binary operator has two operands instead of being one
+        else
+            missing--;
+    }
+    return end;
+}
+
+/**
+ * Checks whether evaluating items[start..end) can stop the program, only division
+ * can. A literal zero divisor is a compile error, a propagated one is left for runtime.
+ */
+static bool can_fail(symbol_vector_t *list, unsigned int start, unsigned int end) {
+    for (unsigned int i = start + 2; i < end; i++) {
+        if (list->items[i].sym_type == SYM_OPERATOR && list->items[i].data.op == S_DIV
+            && (list->items[i - 1].sym_type == SYM_OPERATOR || list->items[i - 1].sym_type == SYM_VAR || equals(&list->items[i - 1], 0)))
+            return true;
+    }
+    return false;
+}
+
+static bool equals(symbol_t *symbol, long value) {
+    if (symbol->sym_type == SYM_INT)
+        return symbol->data.int_val == value;
+    return symbol->data.float64_val == value;
+}
@@ -12,6 +12,12 @@
 
 #include "expression.h"
 
-int optimize(data_t *data, dll_t *list);
+/**
+ * @brief Folds and simplifies the postfix expression in place
+ *
+ * Chains of float64 operators are regrouped only when compiled with
+ * -DFLOAT_REASSOCIATION, the regrouped sums round differently.
+ */
+int optimize(data_t *data, symbol_vector_t *list);
 
 #endif
@@ -15,6 +15,7 @@
 #include "expression.h"
 #include "enum_str.h"
 #include "codegen.h"
+#include "tailcall.h"
 
 #define NEXT_TOKEN() data->prev_token = data->token; if (get_next_token(&data->token) != SCANNER_SUCCESS) return ERR_LEX_STRUCTURE;
 #define RET() return data->result;
@@ -57,9 +58,11 @@ static int returned_vals(data_t *data);
 static int next_returned_val(data_t *data, unsigned int n);
 static int new_scope(data_t *data);
 static int close_scope(data_t *data);
+static int declare_var(data_t *data, var_data_t *vd);
 static int end_of_assignment(data_t *data, dll_node_t *node);
 static int check_ret_vals(data_t *data, char type, unsigned int n);
 static int check_func_calls(data_t *data);
+static int output_functions(data_t *data, func_data_t *main_fd);
 static int command(data_t *data);
 static int function(data_t *data);
 static int const_val_identifier(data_t *data);
@@ -70,14 +73,24 @@ static char tkn_to_char(token token);
 static bool add_to_assign_list(data_t *data, token token);
 static void set_return_types(data_t *data, dll_node_t *node);
 static bool compare_list_of_types(string expected, string sent);
-static var_data_t* create_aux_var();
-
-bool init_func_data(void **ptr);
-func_call_data_t* create_func_call_data();
+static var_data_t* create_aux_var(data_t *data);
+static var_data_t* new_var(data_t *data);
+static int pop_assigned(data_t *data);
+static int inline_builtin(data_t *data);
+static bool inline_arg(data_t *data, var_data_t *vd);
+static bool fold_substr(data_t *data);
+static bool set_value(data_t *data, var_data_t *vd, var_value_t *value);
+static void undo_values(data_t *data, unsigned int mark);
+static bool save_values(data_t *data, unsigned int mark, value_log_t **values, unsigned int *count);
+static bool set_values(data_t *data, value_log_t *values, unsigned int count);
+static bool merge_values(data_t *data, unsigned int mark, value_log_t *if_values, unsigned int if_count);
+static int forget_loop_values(data_t *data);
+
+bool init_func_data(arena *a, void **ptr);
+func_call_data_t* create_func_call_data(arena *a);
 void free_func_data(void *ptr);
-void free_local_scope(void *ptr);
+void free_code(void *ptr);
 void free_func_call_data(void *ptr);
-void free_var_data(void *ptr);
 
 bool init_data(data_t *data)
 {
@@ -86,27 +99,40 @@ bool init_data(data_t *data)
 	data->arg_idx = 0;
 	data->label_idx = 0;
 	data->assign_func = false;
+	data->inline_func = KW_FUNC;
 	data->assign_for = false;
 	data->assign_for_swap_output = false;
 	data->scope_idx = 0;
 	data->allow_relations = false;
-
+	data->const_cond = false;
+	data->unreachable = false;
+	data->expr_value.type = '0';
+	data->version = 0;
+
+	ir_init(&data->dead_code);
+	arena_init(&data->arena);
+	arena_init(&data->func_arena);
 	stack_init(&data->for_assign);
-	stack_init(&data->var_table);
-	stack_init(&data->defvar_table);
+	symtable_init(&data->var_table);
+	stack_init(&data->var_log);
+	symtable_init(&data->defvar_table);
 	stack_init(&data->calls);
+	stack_init(&data->funcs);
+	stack_init(&data->value_log);
 	symtable_init(&data->func_table);
 
+	data->underscore.type = 't';
+	data->underscore.scope_idx = 0;
+	data->underscore.shadowed = NULL;
+	data->underscore.value.type = '0';
+	data->underscore.assigned.type = '0';
+	data->underscore.version = 0;
+	if ((data->underscore.name = atom_intern("_", 1)) == NULL)
+		return false;
+
 	data->assign_list = dll_init();
-	data->arg_list = dll_init();
-	if (data->assign_list == NULL || data->arg_list == NULL)
-	{
-		symtable_dispose(&data->func_table, free_func_data);
-		stack_dispose(&data->calls, free_func_call_data);
-		stack_dispose(&data->var_table, free_local_scope);
-		stack_dispose(&data->defvar_table, free_local_scope);
+	if (data->assign_list == NULL)
 		return false;
-	}
 
 	if (!add_inter_func_to_table(data))
 	{
@@ -121,29 +147,30 @@ void dispose_data(data_t *data)
 {
 	symtable_dispose(&data->func_table, free_func_data);
 	stack_dispose(&data->calls, free_func_call_data);
-	stack_dispose(&data->var_table, free_local_scope);
-	stack_dispose(&data->defvar_table, free_local_scope);
-	stack_dispose(&data->for_assign, free);
+	stack_dispose(&data->funcs, stack_nofree);
+	stack_dispose(&data->value_log, stack_nofree);
+	symtable_dispose(&data->var_table, stack_nofree);
+	stack_dispose(&data->var_log, stack_nofree);
+	symtable_dispose(&data->defvar_table, stack_nofree);
+	stack_dispose(&data->for_assign, free_code);
 	dll_dispose(data->assign_list, stack_nofree);
-	dll_dispose(data->arg_list, stack_nofree);
+	arena_free(&data->func_arena); //variables and expression strings
+	arena_free(&data->arena); //function and call data
+	ir_free(&data->dead_code);
 }
 
-bool init_func_data(void **ptr)
+bool init_func_data(arena *a, void **ptr)
 {
-	*ptr = malloc(sizeof(func_data_t));
+	*ptr = arena_alloc(a, sizeof(func_data_t));
 	if (*ptr == NULL) return false;
 	func_data_t **fd = (func_data_t**)ptr;
 
 	if (!str_init(&(*fd)->args_types))
-	{
-		free(ptr);
 		return false;
-	}
 
 	if (!str_init(&(*fd)->ret_val_types))
 	{
 		str_free(&(*fd)->args_types);
-		free(ptr);
 		return false;
 	}
 
@@ -154,33 +181,31 @@ bool init_func_data(void **ptr)
 		return false;
 	}
 
+	(*fd)->code.name = NULL;
+	ir_init(&(*fd)->code.code);
+	arena_init(&(*fd)->code.text);
+	(*fd)->code.inlined = 0;
+	(*fd)->code.called = false;
 	(*fd)->used_return = false;
+	(*fd)->called = false;
 	return true;
 }
 
-func_call_data_t* create_func_call_data()
+func_call_data_t* create_func_call_data(arena *a)
 {
-	func_call_data_t *fcd = malloc(sizeof(func_call_data_t));
+	func_call_data_t *fcd = arena_alloc(a, sizeof(func_call_data_t));
 	if (fcd == NULL) return NULL;
 
 	if (!str_init(&fcd->args_types))
-	{
-		free(fcd);
 		return NULL;
-	}
-
-	if (!str_init(&fcd->func_name))
-	{
-		str_free(&fcd->args_types);
-		free(fcd);
-		return NULL;
-	}
 
+	fcd->func_name = NULL;
+	fcd->builtin = false;
+	fcd->caller = NULL;
+	fcd->callee = NULL;
 	if (!str_init(&fcd->expected_return))
 	{
 		str_free(&fcd->args_types);
-		str_free(&fcd->func_name);
-		free(fcd);
 		return NULL;
 	}
 	return fcd;
@@ -190,9 +215,7 @@ void free_func_call_data(void *ptr)
 {
 	func_call_data_t *fcd = (func_call_data_t*)ptr;
 	str_free(&fcd->args_types);
-	str_free(&fcd->func_name);
-	str_free(&fcd->expected_return);
-	free(ptr);
+	str_free(&fcd->expected_return); //the struct itself is in the arena
 }
 
 void free_func_data(void *ptr)
@@ -201,20 +224,13 @@ void free_func_data(void *ptr)
 	str_free(&fd->args_types);
 	str_free(&fd->ret_val_types);
 	str_free(&fd->name);
-	free(ptr);
-}
-
-void free_local_scope(void *ptr)
-{
-	stnode_ptr *node = (stnode_ptr*)ptr;
-	symtable_dispose(node, free_var_data);
-	free(ptr);
+	ir_free(&fd->code.code);
+	arena_free(&fd->code.text); //the struct itself is in the arena
 }
 
-void free_var_data(void *ptr)
+void free_code(void *ptr)
 {
-	var_data_t *vd = (var_data_t*)ptr;
-	str_free(&vd->name);
+	ir_free((ir_list*)ptr);
 	free(ptr);
 }
 
@@ -235,7 +251,7 @@ int parse(data_t *data)
 	NEXT_TOKEN()
 	if (TKN.type != TOKEN_IDENTIFIER)
 		return ERR_SYNTAX;
-	if (str_cmp_const(TKN.attr.str, "main") != 0)
+	if (strcmp(TKN.attr.id->str, "main") != 0)
 		return ERR_SYNTAX;
 	
 	//parsing all functions
@@ -252,7 +268,8 @@ int parse(data_t *data)
 	if (fd->ret_val_types.len > 0)
 		return ERR_SEMANTIC_FUNC_PARAMS;
 
-	return check_func_calls(data);
+	APPLY_RULE(check_func_calls)
+	return output_functions(data, fd);
 }
 
 static int func_header(data_t *data)
@@ -260,23 +277,25 @@ static int func_header(data_t *data)
 	if (TKN.type != TOKEN_IDENTIFIER) //name of function
 		return ERR_SYNTAX;
 	
-	char *name = TKN.attr.str->str;
-	if (symtable_search(data->func_table, name) != NULL)
+	const atom *name = TKN.attr.id;
+	if (symtable_search_hash(data->func_table, name->str, name->hash) != NULL)
 		return ERR_SEMANTIC_UNDEF_REDEF; //this funcion name already exist
 
 	bool err;
-	stnode_ptr ptr = symtable_insert(&data->func_table, name, &err);
+	stnode_ptr ptr = symtable_insert_hash(&data->func_table, name->str, name->hash, &err);
 	if (ptr == NULL)
 		return ERR_INTERNAL;
 
-	if (!init_func_data(&ptr->data))
+	if (!init_func_data(&data->arena, &ptr->data))
 	{
-		symtable_delete_node(&data->func_table, name, stack_nofree);
+		symtable_delete_node_hash(&data->func_table, name->str, name->hash, stack_nofree);
 		return ERR_INTERNAL;
 	}
 
 	data->fdata = ptr->data;
-	if (!str_add_const(&data->fdata->name, name))
+	if (!str_add_len(&data->fdata->name, name->str, name->len))
+		return ERR_INTERNAL;
+	if (!stack_push(&data->funcs, data->fdata))
 		return ERR_INTERNAL;
 
 	NEXT_TOKEN()
@@ -284,7 +303,7 @@ static int func_header(data_t *data)
 		return ERR_SYNTAX;
 
 	GEN(gen_func_begin, data->fdata->name.str);
-	str_swap(&ifjcode20_output, &func_body);
+	ir_swap(&ifjcode20_code, &func_body);
 
 	NEXT_TOKEN()
 	if (TKN.type != TOKEN_PAR_CLOSE) //1+ args
@@ -305,36 +324,22 @@ static int func_args(data_t *data)
 		if (!str_add(&data->fdata->args_types, kw_to_char(TKN.attr.kw)))
 			return ERR_INTERNAL;
 		//create var
-		var_data_t *vd = malloc(sizeof(var_data_t));
+		var_data_t *vd = new_var(data);
 		if (vd == NULL)
 			return ERR_INTERNAL;
 
 		vd->type = kw_to_char(TKN.attr.kw);
-		if (!str_init(&vd->name))
-		{
-			free(vd);
-			return ERR_INTERNAL;
-		}
-
-		char *name = data->prev_token.attr.str->str;
-		if (!str_add_const(&vd->name, name))
-		{
-			free_var_data(vd);
-			return ERR_INTERNAL;
-		}
+		vd->name = data->prev_token.attr.id;
 		
 		//add var into local scope
-		bool err;
-		stnode_ptr ptr = symtable_insert((stnode_ptr*)data->var_table.top->data, name, &err);
-		if (ptr == NULL)
-		{
-			free_var_data(vd);
-			return ERR_INTERNAL;
-		}
+		if (find_var(data, vd->name, true) != NULL)
+			return ERR_SEMANTIC_UNDEF_REDEF; //two arguments of the same name
 		vd->scope_idx = data->scope_idx;
-		ptr->data = vd;
+		int result = declare_var(data, vd);
+		if (result != 0)
+			return result;
 
-		GEN(gen_func_arg, vd->name.str, data->arg_idx, vd->scope_idx);
+		GEN(gen_func_arg, vd->name->str, data->arg_idx, vd->scope_idx);
 		data->arg_idx++;
 
 		NEXT_TOKEN()
@@ -416,96 +421,113 @@ static int var_type(data_t *data)
 
 static int call_func(data_t *data)
 {
-	func_call_data_t *call = create_func_call_data();
+	func_call_data_t *call = create_func_call_data(&data->arena);
 	if (call == NULL)
 		return ERR_INTERNAL;
 	
 	call->line = TKN.line;
+	call->caller = data->unreachable ? NULL : data->fdata; //dead code calls nothing
+	data->inline_func = KW_FUNC;
 
-	char *name;
 	if (data->prev_token.type == TOKEN_KEYWORD)
-		name = keyword_str(data->prev_token.attr.kw);
+	{
+		call->builtin = true;
+		keyword kw = data->prev_token.attr.kw;
+		if (data->assign_func && (kw == KW_LEN || kw == KW_INT2FLOAT || kw == KW_FLOAT2INT || kw == KW_ORD || kw == KW_CHR || kw == KW_SUBSTR))
+		{
+			data->inline_func = kw; //written straight into the assigned variables by pop_assigned
+			if (kw != KW_SUBSTR) //substr calls its body unless it is folded
+				call->caller = NULL;
+		}
+		char *name = keyword_str(data->prev_token.attr.kw);
+		call->func_name = atom_intern(name, strlen(name));
+		if (call->func_name == NULL)
+		{
+			free_func_call_data(call);
+			return ERR_INTERNAL;
+		}
+	}
 	else
-		name = data->prev_token.attr.str->str;
+		call->func_name = data->prev_token.attr.id;
 
 	//checking if name of the function is used as variable name
-	if (find_var(data, name, false) != NULL)
+	if (find_var(data, call->func_name, false) != NULL)
 	{
 		free_func_call_data(call);
 		return ERR_SEMANTIC_UNDEF_REDEF;
 	}
 
-	if (!str_add_const(&call->func_name, name))
-	{
-		free_func_call_data(call);
-		return ERR_INTERNAL;
-	}
-
 	if (!stack_push(&data->calls, call))
 	{
 		free_func_call_data(call); 
 		return ERR_INTERNAL;
 	}
 
-	GEN(gen_create_frame);
 	data->arg_idx = 0;
-	data->print = strcmp(((func_call_data_t*)data->calls.top->data)->func_name.str, "print") == 0;
+	data->print = data->prev_token.type == TOKEN_KEYWORD && data->prev_token.attr.kw == KW_PRINT;
+	if (data->print)
+		call->caller = NULL; //every argument is written as it is parsed
+
+	bool called = data->inline_func == KW_FUNC && !data->print;
+	if (called)
+	{
+		GEN(gen_create_frame);
+	}
 	APPLY_NEXT_RULE(func_calling)
-	GEN(gen_func_call, call->func_name.str);
+	if (called)
+	{
+		GEN(gen_func_call, call->func_name->str);
+	}
 	return 0;
 }
 
 static int const_val_identifier(data_t *data)
 {
-	if (TKN.type == TOKEN_IDENTIFIER)
+	if (TKN.type == TOKEN_KEYWORD && TKN.attr.kw == KW_UNDERSCORE)
+		return ERR_SEMANTIC_UNDEF_REDEF;
+	if (TKN.type != TOKEN_IDENTIFIER && TKN.type != TOKEN_INT && TKN.type != TOKEN_STRING && TKN.type != TOKEN_FLOAT64)
+		return ERR_SYNTAX;
+	return 0; //generated by func_calling_n once the argument is complete
+}
+
+/**
+ * @brief Remembers an argument of the builtin expanded at the call site, vd is NULL for a literal
+ */
+static bool inline_arg(data_t *data, var_data_t *vd)
+{
+	str_add(&((func_call_data_t*)stack_top(&data->calls))->args_types, vd != NULL ? vd->type : tkn_to_char(data->prev_token));
+	unsigned long i = data->arg_idx++;
+	if (i >= 3)
+		return true; //wrong number of arguments, reported by the semantic checks
+
+	data->inline_args[i] = gen_token_value(&data->prev_token, vd != NULL ? vd->scope_idx : 0);
+	var_value_t *value = &data->inline_values[i];
+	value->type = '0';
+	if (vd != NULL)
 	{
-		if (data->print)
-		{
-			token *tmp_token = malloc(sizeof(token));
-			tmp_token->type = TKN.type;
-			string *tmp_string = malloc(sizeof(string));
-			str_init(tmp_string);
-			tmp_token->attr.str = tmp_string;
-			str_copy(TKN.attr.str, tmp_token->attr.str);
-			dll_insert_first(data->arg_list, tmp_token);
-		}
+		if (vd->value.type == 'i' || vd->value.type == 's')
+			*value = vd->value;
 	}
-	else if (TKN.type == TOKEN_INT || TKN.type == TOKEN_STRING || TKN.type == TOKEN_FLOAT64)
+	else if (data->prev_token.type == TOKEN_INT)
 	{
-		if (data->print)
-		{
-			token *tmp_token = malloc(sizeof(token));
-			tmp_token->type = TKN.type;
-			string *tmp_string = malloc(sizeof(string));
-			str_init(tmp_string);
-			tmp_token->attr.str = tmp_string;
-			switch (tmp_token->type)
-			{
-				case TOKEN_INT:
-					str_free(tmp_string);
-					free(tmp_string);
-					tmp_token->attr.int_val = TKN.attr.int_val;
-					break;
-				case TOKEN_FLOAT64:
-					str_free(tmp_string);
-					free(tmp_string);
-					tmp_token->attr.float64_val = TKN.attr.float64_val;
-					break;
-				case TOKEN_STRING:
-					str_copy(TKN.attr.str, tmp_token->attr.str);
-					break;
-				default:
-					break;
-			}
-			dll_insert_first(data->arg_list, tmp_token);
-		}
+		value->type = 'i';
+		value->val.int_val = data->prev_token.attr.int_val;
 	}
-	else if (TKN.type == TOKEN_KEYWORD && TKN.attr.kw == KW_UNDERSCORE)
-		return ERR_SEMANTIC_UNDEF_REDEF;
-	else 
-		return ERR_SYNTAX;
-
-	return 0;
+	else if (data->prev_token.type == TOKEN_STRING)
+	{
+		//read-only copy, the scanner reuses its string for the next token
+		string *str = arena_alloc(&data->func_arena, sizeof(string));
+		if (str == NULL)
+			return false;
+		str->str = arena_strndup(&data->func_arena, data->prev_token.attr.str->str, data->prev_token.attr.str->len);
+		if (str->str == NULL)
+			return false;
+		str->len = data->prev_token.attr.str->len;
+		str->mem_size = str->len + 1;
+		value->type = 's';
+		value->val.str = str;
+	}
+	return true;
 }
 
 static int func_calling_n(data_t *data)
@@ -514,55 +536,43 @@ static int func_calling_n(data_t *data)
 	{
 		if (data->prev_token.type == TOKEN_IDENTIFIER) //var
 		{
-			var_data_t *vd = find_var(data, data->prev_token.attr.str->str, false);
+			var_data_t *vd = find_var(data, data->prev_token.attr.id, false);
 			if (vd == NULL) //used undefined variable
 				return ERR_SEMANTIC_UNDEF_REDEF;
 
-			if (!data->print)
+			if (data->inline_func != KW_FUNC)
 			{
-				str_add(&((func_call_data_t*)data->calls.top->data)->args_types, vd->type);
+				if (!inline_arg(data, vd))
+					return ERR_INTERNAL;
+			}
+			else if (data->print)
+			{
+				GEN(gen_write, &data->prev_token, vd->scope_idx);
+			}
+			else
+			{
+				str_add(&((func_call_data_t*)stack_top(&data->calls))->args_types, vd->type);
 				GEN(gen_func_call_arg_idx, data->arg_idx++, &data->prev_token, vd->scope_idx);
 			}
 		}
-		else if (!data->print) //int, string, float
+		else if (data->inline_func != KW_FUNC) //int, string, float
+		{
+			if (!inline_arg(data, NULL))
+				return ERR_INTERNAL;
+		}
+		else if (data->print) //int, string, float
 		{
-			str_add(&((func_call_data_t*)data->calls.top->data)->args_types, tkn_to_char(data->prev_token));
+			GEN(gen_write, &data->prev_token, 0);
+		}
+		else //int, string, float
+		{
+			str_add(&((func_call_data_t*)stack_top(&data->calls))->args_types, tkn_to_char(data->prev_token));
 			GEN(gen_func_call_arg, data->arg_idx++, &data->prev_token);
 		}
 
 		if (TKN.type == TOKEN_PAR_CLOSE)
 		{
 			NEXT_TOKEN()
-			if (data->print)
-			{
-				dll_node_t *tmp = data->arg_list->first;
-				while (tmp != NULL)
-				{
-					//token *td = (token*)tmp->data;
-					if (((token*)tmp->data)->type == TOKEN_IDENTIFIER)
-					{
-						var_data_t *vd = find_var(data, ((token*)tmp->data)->attr.str->str, false);
-						GEN(gen_func_arg_push, (token*)tmp->data, vd->scope_idx);
-					}
-					else
-					{
-						GEN(gen_func_arg_push, (token*)tmp->data, data->scope_idx);
-					}
-
-					if (((token*)tmp->data)->type == TOKEN_STRING || ((token*)tmp->data)->type == TOKEN_IDENTIFIER)
-					{
-						str_free(((token*)tmp->data)->attr.str);
-						free(((token*)tmp->data)->attr.str);
-					}
-					tmp = tmp->next;
-				}
-
-				token tmp_token;
-				tmp_token.type = TOKEN_INT;
-				tmp_token.attr.int_val = data->arg_list->size;
-				GEN(gen_func_arg_push, &tmp_token, 0);
-				dll_clear(data->arg_list, free);
-			}
 			return 0;
 		}
 		
@@ -577,13 +587,6 @@ static int func_calling(data_t *data)
 {
 	if (TKN.type == TOKEN_PAR_CLOSE) //no args
 	{
-		if (data->print)
-		{
-			token tmp_token;
-			tmp_token.type = TOKEN_INT;
-			tmp_token.attr.int_val = 0;
-			GEN(gen_func_arg_push, &tmp_token, data->scope_idx);
-		}
 		NEXT_TOKEN()
 		return 0;
 	}
@@ -619,50 +622,36 @@ static int assignment(data_t *data)
 		if (node->data != NULL)
 		{
 			var_data_t *assign = (var_data_t*)node->data;
-			var_data_t *vd = find_var(data, assign->name.str, true);
+			var_data_t *vd = find_var(data, assign->name, true);
 			if (vd != NULL)
 				return ERR_SEMANTIC_UNDEF_REDEF; //variable alreay exist in current scope
 
-			bool err;
-			stnode_ptr ptr = symtable_insert(((stnode_ptr*)data->var_table.top->data), assign->name.str, &err);
-			if (ptr == NULL)
-				return ERR_INTERNAL;
-
 			// Check if the variable is declared in the same scope_idx but different scope
-			bool declared = false;
-			struct stack_el *elem = data->defvar_table.top;
-			while (elem != NULL)
+			string defvar_name;
+			char idx[20*sizeof(char)];
+			sprintf(idx, "%lu", assign->scope_idx);
+			if (!str_init(&defvar_name))
+				return ERR_INTERNAL;
+			if (!str_add_var(&defvar_name, assign->name->str, "%", idx, NULL))
 			{
-				stnode_ptr bst = *(stnode_ptr*)elem->data;
-				stnode_ptr var_ptr = symtable_search(bst, assign->name.str);
-				if (var_ptr != NULL && var_ptr->data != NULL)
-				{
-					if (((var_data_t*)var_ptr->data)->scope_idx == assign->scope_idx)
-					{
-						declared = true;
-						break;
-					}
-				}
-				elem = elem->next;
+				str_free(&defvar_name);
+				return ERR_INTERNAL;
 			}
 
-			if (!declared)
+			bool err;
+			stnode_ptr defvar_ptr = symtable_insert(&data->defvar_table, defvar_name.str, &err);
+			str_free(&defvar_name);
+			if (err)
+				return ERR_INTERNAL;
+			if (defvar_ptr != NULL) //not declared yet
 			{
-				bool err;
-				stnode_ptr defvar_ptr = symtable_insert(((stnode_ptr*)data->defvar_table.top->data), assign->name.str, &err);
-				if (defvar_ptr == NULL)
-					return ERR_INTERNAL;
-				var_data_t *assign_copy = malloc(sizeof(var_data_t));
-				assign_copy->type = assign->type;
-				assign_copy->scope_idx = assign->scope_idx;
-				str_init(&assign_copy->name);
-				str_copy(&assign->name, &assign_copy->name);
-				defvar_ptr->data = assign_copy;
-				GEN(gen_defvar_str, assign_copy->name.str, assign_copy->scope_idx, &func_declarations);
+				GEN(gen_defvar_str, assign->name->str, assign->scope_idx, &func_declarations);
 			}
 
+			int result = declare_var(data, assign);
+			if (result != 0)
+				return result;
 			assign->type = 't';
-			ptr->data = assign;
 		}
 		node = node->next;
 	}
@@ -672,26 +661,8 @@ static int assignment(data_t *data)
 	data->fix_call = false;
 	data->result = end_of_assignment(data, data->assign_list->first);
 	CHECK_RESULT()
-
-	dll_node_t *tmp = data->assign_list->first;
-	unsigned long i = 0;
-	while (tmp != NULL)
-	{
-		if (data->assign_func)
-		{
-			CODE_INT("PUSHS TF@%%retval"); CODE_NUM(i++); CODE_INT("\n");
-		}
-		if (data->vdata == NULL)
-		{
-			GEN(gen_pop, "%%void", "GF");
-		}
-		else
-		{
-			GEN(gen_pop_idx, data->vdata->name.str, "LF", data->vdata->scope_idx);
-		}
-		
-		tmp = tmp->next;
-	}
+	APPLY_RULE(pop_assigned)
+	data->assign_func = false;
 
 	dll_clear(data->assign_list, stack_nofree);
 	return 0;
@@ -705,12 +676,11 @@ static int reassignment(data_t *data)
 		if (node->data != NULL)
 		{
 			var_data_t *assign = (var_data_t*)node->data;
-			var_data_t *vd = find_var(data, assign->name.str, false);
+			var_data_t *vd = find_var(data, assign->name, false);
 			if (vd == NULL)
 				return ERR_SEMANTIC_UNDEF_REDEF;
 
-			free_var_data(assign); //var exists => free alocated var
-			node->data = vd; //assign existed var to list
+			node->data = vd; //var exists => assign it to list, the allocated one stays in the arena //assign existed var to list
 		}
 		node = node->next;
 	}
@@ -720,55 +690,159 @@ static int reassignment(data_t *data)
 	data->fix_call = false;
 	data->result = end_of_assignment(data, data->assign_list->first);
 	CHECK_RESULT()
-	dll_node_t *tmp = data->assign_list->first;
+	APPLY_RULE(pop_assigned)
+	data->assign_func = false;
+	if (data->assign_for)
+	{
+		ir_swap(&ifjcode20_code, &for_assigns);
+		data->assign_for = false;
+		data->assign_for_swap_output = false;
+		ir_list *tmp_push = malloc(sizeof(ir_list));
+		if (tmp_push == NULL)
+			return ERR_INTERNAL;
+		ir_init(tmp_push);
+		ir_swap(tmp_push, &for_assigns); // take the instructions, for_assigns is left empty
+		stack_push(&data->for_assign, tmp_push);
+	}
+
+	dll_clear(data->assign_list, stack_nofree);
+	return 0;
+}
+
+/**
+ * @brief Pops the assigned values into the variables and remembers the known ones
+ */
+static int pop_assigned(data_t *data)
+{
+	//expressions leave the last value on top of the stack, a call leaves all of them in its frame
+	dll_node_t *node = data->assign_func ? data->assign_list->first : data->assign_list->last;
 	unsigned long i = 0;
-	while (tmp != NULL)
+	unsigned long j = 0; //index of the assigned value
+	bool expanded = data->assign_func && data->inline_func != KW_FUNC;
+	data->inline_results[0].type = data->inline_results[1].type = '0';
+	if (expanded)
+	{
+		APPLY_RULE(inline_builtin)
+		data->inline_func = KW_FUNC;
+	}
+	while (node != NULL)
 	{
-		if (data->assign_func)
+		var_data_t *vd = (var_data_t*)node->data;
+		if (data->assign_func && !expanded)
 		{
-			CODE_INT("PUSHS TF@%%retval"); CODE_NUM(i++); CODE_INT("\n");
+			GEN(gen_push_retval, i++);
 		}
-		if (*((var_data_t*)tmp->data)->name.str == '_')
+		if (vd->name == data->underscore.name)
 		{
-			GEN(gen_pop, "%%void", "GF");
+			if (!expanded)
+			{
+				GEN(gen_pop, "%void", "GF");
+			}
 		}
 		else
 		{
-			GEN(gen_pop_idx, ((var_data_t*)tmp->data)->name.str, "LF", ((var_data_t*)tmp->data)->scope_idx);
+			if (!expanded)
+			{
+				GEN(gen_pop_idx, vd->name->str, "LF", vd->scope_idx);
+			}
+			var_value_t value = vd->assigned;
+			if (data->assign_func)
+			{
+				value.type = '0'; //results of a call are not known
+				if (j < 2)
+					value = data->inline_results[j]; //unless the call was folded
+			}
+			else if (value.type == 'v' && value.val.var->scope_idx > vd->scope_idx)
+				value.type = '0'; //the copied variable goes out of scope sooner
+			if (!set_value(data, vd, &value))
+				return ERR_INTERNAL;
 		}
-		
-		tmp = tmp->next;
+
+		j++;
+		node = data->assign_func ? node->next : node->prev;
 	}
-	if (data->assign_func)
-	{
-		data->assign_func = false;
+	return 0;
+}
+
+/**
+ * @brief Generates the builtin call being assigned in place, its results go straight into the variables
+ */
+static int inline_builtin(data_t *data)
+{
+	ir_operand dst[2];
+	unsigned long ndst = 0;
+	for (dll_node_t *node = data->assign_list->first; node != NULL; node = node->next, ndst++)
+	{
+		var_data_t *vd = (var_data_t*)node->data;
+		if (ndst < 2)
+			dst[ndst] = gen_var_operand(vd->name == data->underscore.name ? NULL : vd->name->str, vd->scope_idx);
+	}
+	if (data->inline_func == KW_SUBSTR && ndst == 2 && fold_substr(data))
+	{
+		//the call is replaced by its results
+		((func_call_data_t*)stack_top(&data->calls))->caller = NULL;
+		token tok;
+		tok.type = TOKEN_STRING;
+		tok.attr.str = data->inline_results[0].val.str;
+		GEN(gen_move, dst[0], gen_token_value(&tok, 0));
+		tok.type = TOKEN_INT;
+		tok.attr.int_val = data->inline_results[1].val.int_val;
+		GEN(gen_move, dst[1], gen_token_value(&tok, 0));
+		return 0;
 	}
-	if (data->assign_for)
+	GEN(gen_builtin_inline, data->inline_func, data->fdata->name.str, data->label_idx++, data->inline_args, data->arg_idx, dst, ndst);
+	return 0;
+}
+
+/**
+ * @brief Evaluates substr of known arguments into inline_results
+ * @return false if an argument is not known or the string is not ASCII, the interpreter counts characters
+ */
+static bool fold_substr(data_t *data)
+{
+	var_value_t *args = data->inline_values;
+	if (data->arg_idx != 3 || args[0].type != 's' || args[1].type != 'i' || args[2].type != 'i')
+		return false;
+
+	string *s = args[0].val.str;
+	for (unsigned int k = 0; k < s->len; k++)
 	{
-		str_swap(&ifjcode20_output, &for_assigns);
-		data->assign_for = false;
-		data->assign_for_swap_output = false;
-		string *tmp_push = malloc(sizeof(string));
-		str_init(tmp_push);
-		str_copy(&for_assigns, tmp_push);
-		stack_push(&data->for_assign, tmp_push);
-		str_clear(&for_assigns);
+		if ((unsigned char)s->str[k] >= 128)
+			return false;
 	}
 
-	dll_clear(data->assign_list, stack_nofree);
-	return 0;
+	long i = args[1].val.int_val, n = args[2].val.int_val;
+	bool err = i < 0 || i > (long)s->len || n < 0;
+	if (!err && n > (long)s->len - i)
+		n = s->len - i;
+
+	string *str = arena_alloc(&data->func_arena, sizeof(string));
+	if (str == NULL)
+		return false;
+	str->len = err ? 0 : n;
+	str->str = arena_strndup(&data->func_arena, err ? "" : s->str + i, str->len);
+	if (str->str == NULL)
+		return false;
+	str->mem_size = str->len + 1;
+
+	data->inline_results[0].type = 's';
+	data->inline_results[0].val.str = str;
+	data->inline_results[1].type = 'i';
+	data->inline_results[1].val.int_val = err;
+	return true;
 }
 
 static int end_of_assignment(data_t *data, dll_node_t *node)
 {	
 	data->vdata = (var_data_t*)node->data;
 	APPLY_RULE(expression)
+	data->vdata->assigned = data->expr_value; //set after all values are evaluated, a, b = b, a reads the old ones
 	data->nassigns += 1;
 
 	if (data->fix_call && data->nassigns == 2) //fix last call
 	{
 		data->fix_call = false;
-		func_call_data_t *call = (func_call_data_t*)data->calls.top->data;
+		func_call_data_t *call = (func_call_data_t*)stack_top(&data->calls);
 		char t = call->expected_return.str[0];
 		str_clear(&call->expected_return);
 		if (!str_add(&call->expected_return, t))
@@ -867,25 +941,235 @@ static int list_of_vars_n(data_t *data)
 	return ERR_SYNTAX;
 }
 
+/**
+ * @brief Sets the known value of a variable, the old one is logged so it can be undone
+ */
+static bool set_value(data_t *data, var_data_t *vd, var_value_t *value)
+{
+	value_log_t *entry = arena_alloc(&data->func_arena, sizeof(value_log_t));
+	if (entry == NULL || !stack_push(&data->value_log, entry))
+		return false;
+
+	entry->var = vd;
+	entry->value = vd->value;
+	entry->version = vd->version;
+	vd->value = *value;
+	vd->version = ++data->version; //copies of the old value are stale
+	return true;
+}
+
+/**
+ * @brief Restores the values logged since mark
+ */
+static void undo_values(data_t *data, unsigned int mark)
+{
+	while (data->value_log.count > mark)
+	{
+		value_log_t *entry = (value_log_t*)stack_top(&data->value_log);
+		entry->var->value = entry->value;
+		entry->var->version = entry->version;
+		stack_pop(&data->value_log, stack_nofree);
+	}
+}
+
+/**
+ * @brief Copies the values changed since mark and restores the old ones
+ */
+static bool save_values(data_t *data, unsigned int mark, value_log_t **values, unsigned int *count)
+{
+	*count = data->value_log.count - mark;
+	*values = NULL;
+	if (*count != 0)
+	{
+		*values = arena_alloc(&data->func_arena, *count * sizeof(value_log_t));
+		if (*values == NULL)
+			return false;
+
+		for (unsigned int i = 0; i < *count; i++)
+		{
+			var_data_t *vd = ((value_log_t*)data->value_log.items[mark + i])->var;
+			(*values)[i].var = vd;
+			(*values)[i].value = vd->value;
+		}
+	}
+	undo_values(data, mark);
+	return true;
+}
+
+static bool set_values(data_t *data, value_log_t *values, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i++)
+	{
+		if (!set_value(data, values[i].var, &values[i].value))
+			return false;
+	}
+	return true;
+}
+
+static var_value_t* saved_value(value_log_t *values, unsigned int count, var_data_t *vd)
+{
+	for (unsigned int i = 0; i < count; i++)
+	{
+		if (values[i].var == vd)
+			return &values[i].value;
+	}
+	return &vd->value; //not changed, the current value holds
+}
+
+static bool same_value(var_value_t *a, var_value_t *b)
+{
+	if (a->type != b->type)
+		return false;
+
+	switch (a->type)
+	{
+		case 'i':
+			return a->val.int_val == b->val.int_val;
+		case 'f': //bitwise, 0.0 and -0.0 differ
+			return memcmp(&a->val.float64_val, &b->val.float64_val, sizeof(double)) == 0;
+		case 's':
+			return a->val.str->len == b->val.str->len && memcmp(a->val.str->str, b->val.str->str, a->val.str->len) == 0;
+		case 'v':
+			return a->val.var == b->val.var && a->version == b->version;
+		default:
+			return true;
+	}
+}
+
+/**
+ * @brief Joins the values after both branches of an if, a value is kept only if both agree on it
+ */
+static bool merge_values(data_t *data, unsigned int mark, value_log_t *if_values, unsigned int if_count)
+{
+	value_log_t *else_values;
+	unsigned int else_count;
+	if (!save_values(data, mark, &else_values, &else_count))
+		return false;
+
+	unsigned int count = if_count + else_count;
+	if (count == 0)
+		return true;
+	value_log_t *merged = arena_alloc(&data->func_arena, count * sizeof(value_log_t));
+	if (merged == NULL)
+		return false;
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		var_data_t *vd = i < if_count ? if_values[i].var : else_values[i - if_count].var;
+		var_value_t *if_value = saved_value(if_values, if_count, vd);
+		var_value_t *else_value = saved_value(else_values, else_count, vd);
+		merged[i].var = vd;
+		merged[i].value = *if_value;
+		if (!same_value(if_value, else_value))
+			merged[i].value.type = '0';
+	}
+	return set_values(data, merged, count);
+}
+
+/**
+ * @brief Forgets the values of variables assigned anywhere in a loop
+ *
+ * The header and the body are scanned ahead, the values known before the loop
+ * hold in every iteration only if nothing in the loop changes them.
+ */
+static int forget_loop_values(data_t *data)
+{
+	var_value_t unknown;
+	unknown.type = '0';
+
+	scanner_pos pos = scanner_tell();
+	token tkn, prev;
+	prev.type = TOKEN_EOL;
+	int depth = 0;
+	while (get_next_token(&tkn) == SCANNER_SUCCESS && tkn.type != TOKEN_EOF)
+	{
+		if (tkn.type == TOKEN_CURLY_OPEN)
+			depth++;
+		else if (tkn.type == TOKEN_CURLY_CLOSE && --depth == 0)
+			break; //end of the body
+		else if (prev.type == TOKEN_IDENTIFIER && (tkn.type == TOKEN_REASSIGN || tkn.type == TOKEN_COMMA))
+		{
+			//a comma also follows call arguments, forgetting those too is only less precise
+			var_data_t *vd = find_var(data, prev.attr.id, false);
+			if (vd != NULL && !set_value(data, vd, &unknown))
+			{
+				scanner_seek(pos);
+				return ERR_INTERNAL;
+			}
+		}
+		prev = tkn;
+	}
+	scanner_seek(pos);
+	return 0;
+}
+
+/**
+ * @brief Redirects the generated code into dead_code while it can never run
+ */
+static void set_unreachable(data_t *data, bool unreachable)
+{
+	if (data->unreachable == unreachable)
+		return;
+
+	ir_swap(&ifjcode20_code, &data->dead_code);
+	if (!unreachable)
+		ir_clear(&data->dead_code);
+	data->unreachable = unreachable;
+}
+
 static int statement(data_t *data)
 {
+	bool unreachable = data->unreachable;
 	APPLY_RULE(condition)
 	if (TKN.type == TOKEN_CURLY_OPEN)
 	{
 		EXPECT_NEXT_TOKEN(TOKEN_EOL)
 		unsigned long curr_idx = data->label_idx;
 		data->label_idx++;
-		GEN(gen_if_start, data->fdata->name.str, curr_idx);
+		//a folded condition needs no jumps, the branch not taken is dropped
+		bool const_cond = data->const_cond;
+		bool cond_value = data->cond_value;
+		if (!const_cond)
+		{
+			GEN(gen_if_start, data->fdata->name.str, curr_idx, data->cond_holds_eq);
+		}
+		set_unreachable(data, unreachable || (const_cond && !cond_value));
+		unsigned int mark = data->value_log.count;
 		APPLY_NEXT_RULE(scope) //new scope if
+		bool if_returns = data->unreachable;
+		set_unreachable(data, unreachable);
+		value_log_t *if_values;
+		unsigned int if_count;
+		if (!save_values(data, mark, &if_values, &if_count)) //the else branch starts from the values before the if
+			return ERR_INTERNAL;
 		NEXT_TOKEN()
 		if (TKN.type == TOKEN_KEYWORD && TKN.attr.kw == KW_ELSE)
 		{
 			EXPECT_NEXT_TOKEN(TOKEN_CURLY_OPEN)
 			EXPECT_NEXT_TOKEN(TOKEN_EOL)
-			GEN(gen_else, data->fdata->name.str, curr_idx);
+			if (!const_cond)
+			{
+				GEN(gen_else, data->fdata->name.str, curr_idx);
+			}
+			set_unreachable(data, unreachable || (const_cond && cond_value));
 			APPLY_NEXT_RULE(scope) //new scope else
+			bool else_returns = data->unreachable;
+			set_unreachable(data, unreachable);
+			//only the values of the branches that fall through reach the code after the if
+			if (else_returns && !if_returns)
+			{
+				undo_values(data, mark);
+				if (!set_values(data, if_values, if_count))
+					return ERR_INTERNAL;
+			}
+			else if (!if_returns && !merge_values(data, mark, if_values, if_count))
+				return ERR_INTERNAL;
 			EXPECT_NEXT_TOKEN(TOKEN_EOL)
-			GEN(gen_endif, data->fdata->name.str, curr_idx);
+			if (!const_cond)
+			{
+				GEN(gen_endif, data->fdata->name.str, curr_idx);
+			}
+			set_unreachable(data, if_returns && else_returns); //nothing after the if runs when neither branch falls through
 			return 0;
 		}
 	}
@@ -925,6 +1209,7 @@ static int func_or_list_of_vars(data_t *data)
 
 static int cycle(data_t *data)
 {
+	bool unreachable = data->unreachable;
 	APPLY_RULE(new_scope)
 
 	unsigned long curr_idx = data->label_idx;
@@ -935,40 +1220,54 @@ static int cycle(data_t *data)
 		data->result = cycle_list_of_assign(data, curr_idx);
 		CHECK_RESULT()
 	}
+	APPLY_RULE(forget_loop_values)
+	unsigned int mark = data->value_log.count;
 
 	//condition i < 10
 	GEN(gen_for_start, data->fdata->name.str, curr_idx);
 	APPLY_NEXT_RULE(condition)
-	GEN(gen_for_cond, data->fdata->name.str, curr_idx);
+	//a folded condition needs no check, a false one drops the whole loop
+	bool const_cond = data->const_cond;
+	bool cond_value = data->cond_value;
+	if (!const_cond)
+	{
+		GEN(gen_for_cond, data->fdata->name.str, curr_idx, data->cond_holds_eq);
+	}
+	set_unreachable(data, unreachable || (const_cond && !cond_value));
 
 	NEXT_TOKEN()
 	if (TKN.type != TOKEN_CURLY_OPEN) //i = i + 1
 	{
 		data->result = end_of_cycle(data, curr_idx);
 		CHECK_RESULT()
+		undo_values(data, mark); //runs after the body
 	}
 	else
 	{
-		string *tmp_push = malloc(sizeof(string));
-		str_init(tmp_push);
+		ir_list *tmp_push = malloc(sizeof(ir_list));
+		if (tmp_push == NULL)
+			return ERR_INTERNAL;
+		ir_init(tmp_push);
 		stack_push(&data->for_assign, tmp_push);
 	}
 
 	EXPECT_NEXT_TOKEN(TOKEN_EOL)
 	APPLY_NEXT_RULE(scope)
 	EXPECT_NEXT_TOKEN(TOKEN_EOL)
+	if (!(const_cond && !cond_value))
+		set_unreachable(data, unreachable); //the body may return, the loop still goes on after it
 
 	APPLY_RULE(close_scope)
 
-	if (data->for_assign.top != NULL)
+	if (data->for_assign.count != 0)
 	{
-		if (!str_add_const(&ifjcode20_output, ((string*)data->for_assign.top->data)->str))
-			return ERR_INTERNAL;
-		str_free((string*)data->for_assign.top->data);
-		stack_pop(&data->for_assign, free);
+		GEN(ir_append, &ifjcode20_code, (ir_list*)stack_top(&data->for_assign));
+		stack_pop(&data->for_assign, free_code);
 	}
 
 	GEN(gen_endfor, data->fdata->name.str, curr_idx);
+	set_unreachable(data, unreachable || (const_cond && cond_value)); //there is no break, an endless loop is left only by return
+	undo_values(data, mark); //the body may not run at all
 	return 0;
 }
 
@@ -1055,8 +1354,7 @@ static int condition(data_t *data)
 	data->allow_func = false;
 	data->allow_relations = true;
 	APPLY_RULE(expression)
-	data->allow_relations = false;
-	GEN(gen_pop, "%%res", "GF");
+	data->allow_relations = false; //the jump on the compared values is generated by the statement
 	return 0;
 }
 
@@ -1069,37 +1367,26 @@ static int returned_vals(data_t *data)
 		return 0;
 	}
 
-	var_data_t *aux1 = create_aux_var();
+	var_data_t *aux1 = create_aux_var(data);
 	if (aux1 == NULL)
 		return ERR_INTERNAL;
 	data->vdata = aux1;
 
 	data->allow_func = false;
-	APPLY_RULE_ERR(expression)
-	{
-		free_var_data(aux1);
-		RET()
-	}
+	APPLY_RULE(expression)
 
 	data->result = check_ret_vals(data, aux1->type, 0);
-	CHECK_RESULT_ERR()
-	{
-		free_var_data(aux1);
-		RET()
-	}
+	CHECK_RESULT()
 
 	data->arg_idx = 0;
 	GEN(gen_func_set_retval, data->arg_idx);
 	data->arg_idx++;
 
-	free_var_data(aux1);
-
 	if (TKN.type == TOKEN_COMMA)
 	{
 		NEXT_TOKEN()
 		data->result = next_returned_val(data, 1);		
 		CHECK_RESULT()
-		GEN(gen_func_return, data->fdata->name.str);
 		return 0;
 	}
 	else if (TKN.type == TOKEN_EOL)
@@ -1113,28 +1400,18 @@ static int returned_vals(data_t *data)
 
 static int next_returned_val(data_t *data, unsigned int n)
 {
-	var_data_t *auxn = create_aux_var();
+	var_data_t *auxn = create_aux_var(data);
 	if (auxn == NULL)
 		return ERR_INTERNAL;
 	data->vdata = auxn;	
 
 	data->allow_func = false;
-	APPLY_RULE_ERR(expression) 
-	{
-		free_var_data(auxn);
-		RET()
-	}
+	APPLY_RULE(expression)
 	GEN(gen_func_set_retval, data->arg_idx);
 	data->arg_idx++;
 
 	data->result = check_ret_vals(data, auxn->type, n);
-	CHECK_RESULT_ERR()
-	{
-		free_var_data(auxn);
-		RET()
-	}
-
-	free_var_data(auxn);
+	CHECK_RESULT()
 
 	if (TKN.type == TOKEN_COMMA)
 	{
@@ -1152,62 +1429,52 @@ static int next_returned_val(data_t *data, unsigned int n)
 	return ERR_SYNTAX;
 }
 
-static int new_scope(data_t *data)
+static int declare_var(data_t *data, var_data_t *vd)
 {
-	stnode_ptr *local_scope = malloc(sizeof(stnode_ptr));
-	if (local_scope == NULL)
-		return ERR_INTERNAL;
-
-	symtable_init(local_scope);
-
-	var_data_t *assign = malloc(sizeof(var_data_t));
-	str_init(&assign->name);
-	str_add(&assign->name, '_');
-	assign->type = 't';
-	assign->scope_idx = data->scope_idx;
 	bool err;
-	stnode_ptr ptr = symtable_insert(local_scope, "_", &err);
-	if (ptr == NULL || err)
+	stnode_ptr ptr = symtable_insert_hash(&data->var_table, vd->name->str, vd->name->hash, &err);
+	if (err)
 		return ERR_INTERNAL;
-	ptr->data = assign;
 
-	if (!stack_push(&data->var_table, local_scope))
+	if (ptr == NULL) //shadows a variable from an outer scope
 	{
-		free(local_scope);
-		return ERR_INTERNAL;
+		ptr = symtable_search_hash(data->var_table, vd->name->str, vd->name->hash);
+		vd->shadowed = ptr->data;
 	}
+	else
+		vd->shadowed = NULL;
 
-	// Local (function) symtable with all scope declarations for DEFVAR generation
-	stnode_ptr *defvar_local_scope = malloc(sizeof(stnode_ptr));
-	if (defvar_local_scope == NULL)
-		return ERR_INTERNAL;
-
-	symtable_init(defvar_local_scope);
-
-	var_data_t *defvar_assign = malloc(sizeof(var_data_t));
-	str_init(&defvar_assign->name);
-	str_add(&defvar_assign->name, '_');
-	defvar_assign->type = 't';
-	defvar_assign->scope_idx = data->scope_idx;
-	bool defvar_err;
-	stnode_ptr defvar_ptr = symtable_insert(defvar_local_scope, "_", &defvar_err);
-	if (defvar_ptr == NULL || defvar_err)
-		return ERR_INTERNAL;
-	defvar_ptr->data = defvar_assign;
-
-	if (!stack_push(&data->defvar_table, defvar_local_scope))
+	if (!stack_push(&data->var_log, vd))
 	{
-		free(defvar_local_scope);
+		if (vd->shadowed == NULL)
+			symtable_delete_node_hash(&data->var_table, vd->name->str, vd->name->hash, stack_nofree);
 		return ERR_INTERNAL;
 	}
+	ptr->data = vd;
+	return 0;
+}
 
+static int new_scope(data_t *data)
+{
 	data->scope_idx++;
 	return 0;
 }
 
 static int close_scope(data_t *data)
 {
-	stack_pop(&data->var_table, free_local_scope);
+	//undo the declarations of the closed scope, the log top is the innermost one
+	while (data->var_log.count != 0)
+	{
+		var_data_t *vd = (var_data_t*)stack_top(&data->var_log);
+		if (vd->scope_idx != data->scope_idx)
+			break;
+
+		if (vd->shadowed == NULL)
+			symtable_delete_node_hash(&data->var_table, vd->name->str, vd->name->hash, stack_nofree);
+		else
+			symtable_search_hash(data->var_table, vd->name->str, vd->name->hash)->data = vd->shadowed;
+		stack_pop(&data->var_log, stack_nofree);
+	}
 	data->scope_idx--;
 	return 0;
 }
@@ -1244,7 +1511,7 @@ static bool add_inter_func_to_table(data_t *data)
 	//inputs
 	ptr = symtable_insert(&data->func_table, "inputs", &err);
 	if (ptr == NULL) return false;
-	if (!init_func_data(&ptr->data)) 
+	if (!init_func_data(&data->arena, &ptr->data)) 
 	{
 		symtable_delete_node(&data->func_table, "inputs", stack_nofree);
 		return false;
@@ -1253,7 +1520,7 @@ static bool add_inter_func_to_table(data_t *data)
 	//inputi
 	ptr = symtable_insert(&data->func_table, "inputi", &err);
 	if (ptr == NULL) return false;
-	if (!init_func_data(&ptr->data)) 
+	if (!init_func_data(&data->arena, &ptr->data)) 
 	{
 		symtable_delete_node(&data->func_table, "inputi", stack_nofree);
 		return false;
@@ -1262,7 +1529,7 @@ static bool add_inter_func_to_table(data_t *data)
 	//inputf
 	ptr = symtable_insert(&data->func_table, "inputf", &err);
 	if (ptr == NULL) return false;
-	if (!init_func_data(&ptr->data)) 
+	if (!init_func_data(&data->arena, &ptr->data)) 
 	{
 		symtable_delete_node(&data->func_table, "inputf", stack_nofree);
 		return false;
@@ -1271,7 +1538,7 @@ static bool add_inter_func_to_table(data_t *data)
 	//print
 	ptr = symtable_insert(&data->func_table, "print", &err);
 	if (ptr == NULL) return false;
-	if (!init_func_data(&ptr->data)) 
+	if (!init_func_data(&data->arena, &ptr->data)) 
 	{
 		symtable_delete_node(&data->func_table, "print", stack_nofree);
 		return false;
@@ -1279,7 +1546,7 @@ static bool add_inter_func_to_table(data_t *data)
 	//int2float
 	ptr = symtable_insert(&data->func_table, "int2float", &err);
 	if (ptr == NULL) return false;
-	if (!init_func_data(&ptr->data)) 
+	if (!init_func_data(&data->arena, &ptr->data)) 
 	{
 		symtable_delete_node(&data->func_table, "int2float", stack_nofree);
 		return false;
@@ -1289,7 +1556,7 @@ static bool add_inter_func_to_table(data_t *data)
 	//float2int
 	ptr = symtable_insert(&data->func_table, "float2int", &err);
 	if (ptr == NULL) return false;
-	if (!init_func_data(&ptr->data)) 
+	if (!init_func_data(&data->arena, &ptr->data)) 
 	{
 		symtable_delete_node(&data->func_table, "float2int", stack_nofree);
 		return false;
@@ -1299,7 +1566,7 @@ static bool add_inter_func_to_table(data_t *data)
 	//len
 	ptr = symtable_insert(&data->func_table, "len", &err);
 	if (ptr == NULL) return false;
-	if (!init_func_data(&ptr->data)) 
+	if (!init_func_data(&data->arena, &ptr->data)) 
 	{
 		symtable_delete_node(&data->func_table, "len", stack_nofree);
 		return false;
@@ -1309,7 +1576,7 @@ static bool add_inter_func_to_table(data_t *data)
 	//substr
 	ptr = symtable_insert(&data->func_table, "substr", &err);
 	if (ptr == NULL) return false;
-	if (!init_func_data(&ptr->data)) 
+	if (!init_func_data(&data->arena, &ptr->data)) 
 	{
 		symtable_delete_node(&data->func_table, "substr", stack_nofree);
 		return false;
@@ -1319,7 +1586,7 @@ static bool add_inter_func_to_table(data_t *data)
 	//ord
 	ptr = symtable_insert(&data->func_table, "ord", &err);
 	if (ptr == NULL) return false;
-	if (!init_func_data(&ptr->data)) 
+	if (!init_func_data(&data->arena, &ptr->data)) 
 	{
 		symtable_delete_node(&data->func_table, "ord", stack_nofree);
 		return false;
@@ -1329,7 +1596,7 @@ static bool add_inter_func_to_table(data_t *data)
 	//chr
 	ptr = symtable_insert(&data->func_table, "chr", &err);
 	if (ptr == NULL) return false;
-	if (!init_func_data(&ptr->data)) 
+	if (!init_func_data(&data->arena, &ptr->data)) 
 	{
 		symtable_delete_node(&data->func_table, "chr", stack_nofree);
 		return false;
@@ -1342,16 +1609,16 @@ static bool add_inter_func_to_table(data_t *data)
 
 static int check_func_calls(data_t *data)
 {
-	struct stack_el *elem = data->calls.top;
-	while (elem != NULL)
+	for (unsigned int i = data->calls.count; i-- > 0;) //latest call first
 	{
-		func_call_data_t *fcd = (func_call_data_t*)elem->data;
-		stnode_ptr ptr = symtable_search(data->func_table, fcd->func_name.str);
+		func_call_data_t *fcd = (func_call_data_t*)data->calls.items[i];
+		stnode_ptr ptr = symtable_search_hash(data->func_table, fcd->func_name->str, fcd->func_name->hash);
 		if (ptr == NULL) //called funcion does not exist
 			return ERR_SEMANTIC_UNDEF_REDEF;
 
 		func_data_t *fdata = (func_data_t*)ptr->data;
-		if (str_cmp_const(&fcd->func_name, "print") == 0)
+		fcd->callee = fdata;
+		if (strcmp(fcd->func_name->str, "print") == 0)
 		{
 			if (fcd->expected_return.len != 0)
 				return ERR_SEMANTIC_FUNC_PARAMS;
@@ -1364,25 +1631,76 @@ static int check_func_calls(data_t *data)
 			if (!compare_list_of_types(fcd->expected_return, fdata->ret_val_types)) //checking returned types
 				return ERR_SEMANTIC_FUNC_PARAMS;
 		}
-		elem = elem->next;
 	}
 	return 0;
 }
 
-var_data_t* find_var(data_t *data, const char *name, bool local)
+/**
+ * @brief Writes out main, the functions it reaches and the builtins they call
+ */
+static int output_functions(data_t *data, func_data_t *main_fd)
 {
-	struct stack_el *elem = data->var_table.top;
-	while (elem != NULL)
+	main_fd->called = true;
+	bool changed = true;
+	while (changed) //until no call adds a function
 	{
-		stnode_ptr *bst = (stnode_ptr*)elem->data;
-		stnode_ptr var_ptr = symtable_search(*bst, name);
-		if (var_ptr != NULL) //var find in this scope
-			return (var_data_t*)(var_ptr->data);
-		else if (local)
-			return NULL;
-		elem = elem->next;
+		changed = false;
+		for (unsigned int i = 0; i < data->calls.count; i++)
+		{
+			func_call_data_t *fcd = (func_call_data_t*)data->calls.items[i];
+			if (fcd->caller == NULL || !fcd->caller->called || fcd->callee->called)
+				continue;
+
+			fcd->callee->called = true;
+			changed = true;
+			if (fcd->builtin)
+				GEN(gen_builtin_function, fcd->func_name->str);
+		}
 	}
-	return NULL; //undefined variable
+
+	//the calls of small functions are replaced by their code, a function is written out only if still called
+	ir_func **funcs = arena_alloc(&data->arena, (data->funcs.count + 1) * sizeof(ir_func*));
+	if (funcs == NULL)
+		return ERR_INTERNAL;
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < data->funcs.count; i++)
+	{
+		func_data_t *fd = (func_data_t*)data->funcs.items[i];
+		if (fd->called)
+			funcs[count++] = &fd->code;
+	}
+	GEN(inliner, funcs, count);
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		if (funcs[i]->called)
+		{
+			//returned calls become jumps
+			GEN(tail_calls, funcs[i]);
+			GEN(gen_func_output, &funcs[i]->code);
+		}
+		//the code is not needed once written out
+		ir_free(&funcs[i]->code);
+		arena_free(&funcs[i]->text);
+		ir_init(&funcs[i]->code);
+		arena_init(&funcs[i]->text);
+	}
+	return 0;
+}
+
+var_data_t* find_var(data_t *data, const atom *name, bool local)
+{
+	if (name == data->underscore.name)
+		return &data->underscore;
+
+	stnode_ptr var_ptr = symtable_search_hash(data->var_table, name->str, name->hash);
+	if (var_ptr == NULL)
+		return NULL; //undefined variable
+
+	var_data_t *vd = (var_data_t*)var_ptr->data;
+	if (local && vd->scope_idx != data->scope_idx)
+		return NULL; //declared in an outer scope
+	return vd;
 }
 
 static char tkn_to_char(token token)
@@ -1400,51 +1718,24 @@ static char tkn_to_char(token token)
 
 static bool add_to_assign_list(data_t *data, token token)
 {	
-	var_data_t *vd = malloc(sizeof(var_data_t));
+	var_data_t *vd = new_var(data);
 	if (vd == NULL)
 		return false;
 
-	if (!str_init(&vd->name))
-	{
-		str_free(token.attr.str);
-		free(vd);
-		return false;
-	}
-
-	if (token.attr.kw == KW_UNDERSCORE)
-	{
-		if (!str_add(&vd->name, '_'))
-		{
-			str_free(token.attr.str);
-			free_var_data(vd);
-			return false;
-		}
-	}
+	if (token.type == TOKEN_KEYWORD && token.attr.kw == KW_UNDERSCORE)
+		vd->name = data->underscore.name;
 	else
-	{
-		if (!str_add_const(&vd->name, token.attr.str->str))
-		{
-			str_free(token.attr.str);
-			free_var_data(vd);
-			return false;
-		}
-	}
-
+		vd->name = token.attr.id;
 
 	vd->type = tkn_to_char(token);
 	vd->scope_idx = data->scope_idx;
 
-	if (!dll_insert_last(data->assign_list, vd))
-	{
-		free_var_data(vd);
-		return false;
-	}	
-	return true;
+	return dll_insert_last(data->assign_list, vd);
 }
 
 static void set_return_types(data_t *data, dll_node_t *node)
 {
-	func_call_data_t *call = (func_call_data_t*)data->calls.top->data;
+	func_call_data_t *call = (func_call_data_t*)stack_top(&data->calls);
 	if (node == NULL)
 	{
 		str_clear(&call->expected_return);
@@ -1458,7 +1749,7 @@ static void set_return_types(data_t *data, dll_node_t *node)
 			else 
 			{
 				var_data_t *vd = (var_data_t*)node->data;
-				var_data_t *fvd = find_var(data, vd->name.str, false);
+				var_data_t *fvd = find_var(data, vd->name, false);
 				str_add(&call->expected_return, fvd->type);
 			}
 			node = node->next;
@@ -1478,19 +1769,26 @@ static void set_return_types(data_t *data, dll_node_t *node)
 	}
 }
 
-static var_data_t* create_aux_var()
+static var_data_t* create_aux_var(data_t *data)
 {
-	var_data_t *vd = malloc(sizeof(var_data_t));
+	var_data_t *vd = new_var(data);
 	if (vd == NULL)
 		return NULL;
 
 	vd->type = 't';
-	if (!str_init(&vd->name))
-	{
-		free(vd);
+	vd->name = NULL; //auxiliary variables have no name
+	return vd;
+}
+
+static var_data_t* new_var(data_t *data)
+{
+	var_data_t *vd = arena_alloc(&data->func_arena, sizeof(var_data_t));
+	if (vd == NULL)
 		return NULL;
-	}
 
+	vd->value.type = '0'; //nothing is known before the first assignment
+	vd->assigned.type = '0';
+	vd->version = 0;
 	return vd;
 }
 
@@ -1551,18 +1849,18 @@ static int function(data_t *data)
 		APPLY_NEXT_RULE(func_header)
 		APPLY_NEXT_RULE(_scope_);
 		APPLY_RULE(close_scope)
+		set_unreachable(data, false);
 
 		GEN(gen_func_end, data->fdata->name.str);
-		str_swap(&ifjcode20_output, &func_body);
-		GEN(str_add_str, &ifjcode20_output, &func_declarations); // append function declarations
-		GEN(str_add_str, &ifjcode20_output, &func_body); // append function body
-		str_clear(&func_declarations);
-		str_clear(&func_body);
+		ir_swap(&ifjcode20_code, &func_body);
+		data->fdata->code.name = data->fdata->name.str;
+		GEN(gen_func_flush, &data->fdata->code.code, &data->fdata->code.text); // the function is complete, optimize and keep it
 		data->arg_idx = 0;
 		data->label_idx = 0;
 		data->scope_idx = 0;
-		stack_dispose(&data->var_table, free_local_scope); // dispose all scopes at the end of a function
-		stack_dispose(&data->defvar_table, free_local_scope); // dispose all scopes at the end of a function
+		symtable_dispose(&data->defvar_table, stack_nofree); // generated names are local to the function
+		stack_clear(&data->value_log, stack_nofree);
+		arena_reset(&data->func_arena); // so are all variables and expression strings
 
 		if (!data->fdata->used_return)
 			return ERR_SEMANTIC_FUNC_PARAMS;
@@ -1614,6 +1912,8 @@ static int command(data_t *data)
 		{
 			data->fdata->used_return = true;
 			APPLY_NEXT_RULE(returned_vals)
+			GEN(gen_func_return, data->fdata->name.str);
+			set_unreachable(data, true); //the rest of the block is dropped
 		}
 		else
 			return ERR_SYNTAX;
@@ -15,6 +15,9 @@
 #include "symtable.h"
 #include "stack.h"
 #include "dll.h"
+#include "arena.h"
+#include "ir.h"
+#include "inliner.h"
 
 typedef struct
 {
@@ -22,23 +25,58 @@ typedef struct
 	string ret_val_types;
 	string name;
 	bool used_return;
+	ir_func code; //optimized code of the function, written out only if main still calls it after inlining
+	bool called;  //reachable from main
 } func_data_t;
 
 typedef struct
 {
 	string args_types;
-	string func_name;
+	const atom *func_name;
 	string expected_return;
 	int line;
+	bool builtin;	      //the generator provides the code of the called function
+	func_data_t *caller;  //function containing the call, NULL if no CALL is generated for it
+	func_data_t *callee;  //set once all functions are known
 } func_call_data_t;
 
+/**
+ * @brief Value of a variable known at compile time
+ */
 typedef struct
+{
+	char type; //'i', 'f' or 's' for a constant, 'v' for a copy of another variable, '0' if unknown
+	union
+	{
+		long int_val;
+		double float64_val;
+		string *str;
+		struct var_data *var;
+	} val;
+	unsigned long version; //version of the copied variable, the copy is stale once it changes
+} var_value_t;
+
+typedef struct var_data
 {
 	char type;
-	string name;
+	const atom *name;
 	unsigned long scope_idx;
+	struct var_data *shadowed; //variable of the same name in an outer scope
+	var_value_t value;	   //known value, propagated into expressions
+	var_value_t assigned;	   //value of the statement being parsed, set after all its expressions
+	unsigned long version;	   //changes with every assignment
 } var_data_t;
 
+/**
+ * @brief Entry of the log of changed known values
+ */
+typedef struct
+{
+	var_data_t *var;
+	var_value_t value;
+	unsigned long version;
+} value_log_t;
+
 /**
  * @brief Struct of some data needed for parsing
  * 
@@ -54,13 +92,24 @@ typedef struct
 	dll_t *assign_list;
 	int nassigns;
 
-	stnode_ptr func_table; //BST of functins
-	stack var_table;	   //symbol table for variables (stack of BSTs)
-	stack defvar_table;	   //symbol table for variables declarations (stack of BSTs)
+	symtable_ptr func_table; //hash table of functins
+	symtable_ptr var_table;	   //visible variables, each node holds the innermost one
+	stack var_log;		   //declared variables in declaration order, undone at the scope exit
+	symtable_ptr defvar_table; //generated variable names (name%scope_idx) declared in the current function
+	var_data_t underscore;	   //the '_' variable, visible in every scope
 	stack calls;		   //stack of all function calls
+	stack funcs;		   //defined functions in the order of their definitions
 
 	bool print;
 	bool used_relations;
+	bool const_cond; //the last condition was folded at compile time
+	bool cond_value; //value of the folded condition
+	bool cond_holds_eq; //the condition left two values on the stack, it holds if they are equal (or if not)
+	bool unreachable; //the code being parsed can never run
+	var_value_t expr_value; //known value of the last expression
+	stack value_log;	//changes of known values, undone where control flow joins
+	unsigned long version;	//last version given to a variable
+	ir_list dead_code;	  //output of the unreachable code, thrown away
 	char current_type;
 	bool allow_func;
 	bool allow_relations;
@@ -68,12 +117,18 @@ typedef struct
 	int result;
 	unsigned long arg_idx;
 	unsigned long label_idx;
-	dll_t *arg_list;
 	bool assign_func;
+	keyword inline_func;	  //builtin expanded at the call site, KW_FUNC if the call is generated
+	ir_operand inline_args[3]; //arguments of the expanded builtin
+	var_value_t inline_values[3]; //arguments known at compile time, a substr of constants is folded
+	var_value_t inline_results[2]; //results of the folded builtin, '0' if unknown
 	bool assign_for;
 	bool assign_for_swap_output;
 	stack for_assign;
 	unsigned long scope_idx;
+
+	arena arena;	  //function and call data, freed at the end of compilation
+	arena func_arena; //variables and expression strings, reset after every function
 } data_t;
 
 /**
@@ -104,11 +159,11 @@ void dispose_data(data_t *data);
  * @brief Finds variable in symbol table
  * 
  * @param data parser's data
- * @param str name of variable
+ * @param name interned name of variable
  * @param local true for searching only in local scope
  * @return var_data_t* 
  */
-var_data_t* find_var(data_t *data, const char *str, bool local);
+var_data_t* find_var(data_t *data, const atom *name, bool local);
 
 /**
  * @brief Check if token is internal function
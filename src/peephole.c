@@ -0,0 +1,297 @@
+/**
+ * Project name: Imperative language IFJ20 compiler implementation
+ * Název projektu: Implementace překladače imperativního jazyka IFJ20
+ *
+ * @brief Peephole optimizer implementation
+ *
+ * @author Daniel Moudrý <xmoudr01 at stud.fit.vutbr.cz>
+ */
+
+#include <string.h>
+#include "peephole.h"
+
+#define MAX_PENDING 32
+
+static const ir_operand regs[PEEPHOLE_REGS] = {
+    { IR_VAR, "GF@%reg0" }, { IR_VAR, "GF@%reg1" }, { IR_VAR, "GF@%reg2" }, { IR_VAR, "GF@%reg3" }
+};
+
+typedef struct {
+    ir_list out;
+    ir_operand pending[MAX_PENDING]; // pushed operands not emitted yet, the last one is on top
+    unsigned int count;
+} state_t;
+
+static bool emit(state_t *s, ir_opcode op, unsigned int nargs, const ir_operand *a, const ir_operand *b, const ir_operand *c);
+static bool flush(state_t *s);
+static bool flush_if_used(state_t *s, const ir_operand *var);
+static const ir_operand *free_reg(state_t *s);
+static ir_opcode direct_op(ir_instr *code, unsigned int i, unsigned int count, unsigned int *arity, unsigned int *len);
+static int fuse(state_t *s, ir_instr *code, unsigned int i, unsigned int count);
+static bool jumps_to_next(ir_instr *code, unsigned int i, unsigned int count);
+static void mark_reachable(ir_list *code, ir_block *blocks, int nblocks, bool *reachable);
+static bool optimize_block(state_t *s, ir_list *code, ir_block *block);
+
+bool peephole(ir_list *code) {
+    ir_block *blocks;
+    int nblocks = ir_blocks(code, &blocks);
+    if (nblocks < 0)
+        return false;
+    bool *reachable = calloc(nblocks + 1, sizeof(bool));
+    if (reachable == NULL) {
+        free(blocks);
+        return false;
+    }
+    mark_reachable(code, blocks, nblocks, reachable);
+
+    state_t s;
+    ir_init(&s.out);
+    s.count = 0;
+
+    bool ok = true;
+    for (int b = 0; ok && b < nblocks; b++) {
+        if (!reachable[b])
+            continue; // nothing jumps or falls through to it
+        ok = optimize_block(&s, code, &blocks[b]);
+    }
+    free(reachable);
+    free(blocks);
+
+    if (!ok) {
+        free(s.out.items);
+        return false;
+    }
+    free(code->items);
+    code->items = s.out.items;
+    code->count = s.out.count;
+    code->size = s.out.size;
+    return true;
+}
+
+/**
+ * Marks the blocks that can run, the first one is the function entry.
+ */
+static void mark_reachable(ir_list *code, ir_block *blocks, int nblocks, bool *reachable) {
+    reachable[0] = nblocks > 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int b = 0; b < nblocks; b++) {
+            if (!reachable[b])
+                continue;
+            ir_instr *last = &code->items[blocks[b].end - 1];
+            if (!ir_is_unconditional(last->op) && b + 1 < nblocks && !reachable[b + 1])
+                reachable[b + 1] = changed = true;
+            if (last->op != IR_JUMP && last->op != IR_JUMPIFEQ && last->op != IR_JUMPIFNEQ
+                && last->op != IR_JUMPIFEQS && last->op != IR_JUMPIFNEQS)
+                continue;
+            for (int t = 0; t < nblocks; t++) {
+                ir_instr *first = &code->items[blocks[t].start];
+                if (!reachable[t] && first->op == IR_LABEL && ir_operand_equal(&first->args[0], &last->args[0]))
+                    reachable[t] = changed = true;
+            }
+        }
+    }
+}
+
+/**
+ * Rewrites the instructions of a basic block, pushes are followed only within it.
+ */
+static bool optimize_block(state_t *s, ir_list *code, ir_block *block) {
+    bool ok = true;
+    for (unsigned int i = block->start; ok && i < block->end; i++) {
+        ir_instr *instr = &code->items[i];
+        if (instr->op == IR_PUSHS) {
+            if (s->count == MAX_PENDING)
+                ok = flush(s);
+            s->pending[s->count++] = instr->args[0];
+            continue;
+        }
+
+        int used = fuse(s, code->items, i, block->end);
+        if (used < 0)
+            return false;
+        if (used > 0) {
+            i += used - 1;
+            continue;
+        }
+
+        if ((instr->op == IR_JUMPIFEQS || instr->op == IR_JUMPIFNEQS) && s->count >= 2) {
+            // PUSHS a, PUSHS b, JUMPIFEQS label is JUMPIFEQ label a b
+            ir_operand ops[2] = { s->pending[s->count - 2], s->pending[s->count - 1] };
+            s->count -= 2;
+            ok = flush(s) && emit(s, instr->op == IR_JUMPIFEQS ? IR_JUMPIFEQ : IR_JUMPIFNEQ, 3, &instr->args[0], &ops[0], &ops[1]);
+            continue;
+        }
+
+        if (instr->op == IR_POPS && s->count > 0) {
+            // PUSHS x, POPS y is MOVE y x
+            ir_operand top = s->pending[--s->count];
+            ok = flush_if_used(s, &instr->args[0]);
+            if (ok && !ir_operand_equal(&top, &instr->args[0]))
+                ok = emit(s, IR_MOVE, 2, &instr->args[0], &top, NULL);
+            continue;
+        }
+
+        // the stack has to be complete at every jump and instruction not followed here
+        ok = flush(s);
+        if (instr->op == IR_JUMP && jumps_to_next(code->items, i, code->count))
+            continue;
+        if (ok)
+            ok = ir_add(&s->out, instr);
+    }
+    return ok && flush(s); // and at the end of the block
+}
+
+static bool emit(state_t *s, ir_opcode op, unsigned int nargs, const ir_operand *a, const ir_operand *b, const ir_operand *c) {
+    ir_instr instr;
+    instr.op = op;
+    instr.nargs = nargs;
+    if (a != NULL)
+        instr.args[0] = *a;
+    if (b != NULL)
+        instr.args[1] = *b;
+    if (c != NULL)
+        instr.args[2] = *c;
+    return ir_add(&s->out, &instr);
+}
+
+/**
+ * Emits the pending pushes.
+ */
+static bool flush(state_t *s) {
+    for (unsigned int i = 0; i < s->count; i++) {
+        if (!emit(s, IR_PUSHS, 1, &s->pending[i], NULL, NULL))
+            return false;
+    }
+    s->count = 0;
+    return true;
+}
+
+/**
+ * Emits the pending pushes before var is written, they have to push its old value.
+ */
+static bool flush_if_used(state_t *s, const ir_operand *var) {
+    for (unsigned int i = 0; i < s->count; i++) {
+        if (ir_operand_equal(&s->pending[i], var))
+            return flush(s);
+    }
+    return true;
+}
+
+static const ir_operand *free_reg(state_t *s) {
+    for (unsigned int r = 0; r < PEEPHOLE_REGS; r++) {
+        unsigned int i = 0;
+        while (i < s->count && !ir_operand_equal(&s->pending[i], &regs[r]))
+            i++;
+        if (i == s->count)
+            return &regs[r];
+    }
+    return NULL;
+}
+
+/**
+ * Checks whether the jump at code[i] targets one of the labels right after it.
+ */
+static bool jumps_to_next(ir_instr *code, unsigned int i, unsigned int count) {
+    for (unsigned int j = i + 1; j < count && code[j].op == IR_LABEL; j++) {
+        if (ir_operand_equal(&code[i].args[0], &code[j].args[0]))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Returns the direct form of the stack operation at code[i], IR_OPCODE_COUNT if there is none.
+ * The string concatenation sequence of the generator counts as one operation of len instructions.
+ */
+static ir_opcode direct_op(ir_instr *code, unsigned int i, unsigned int count, unsigned int *arity, unsigned int *len) {
+    *arity = 2;
+    *len = 1;
+    switch (code[i].op) {
+        case IR_ADDS:
+            return IR_ADD;
+        case IR_SUBS:
+            return IR_SUB;
+        case IR_MULS:
+            return IR_MUL;
+        case IR_DIVS:
+            return IR_DIV;
+        case IR_IDIVS:
+            return IR_IDIV;
+        case IR_LTS:
+            return IR_LT;
+        case IR_GTS:
+            return IR_GT;
+        case IR_EQS:
+            return IR_EQ;
+        case IR_ANDS:
+            return IR_AND;
+        case IR_ORS:
+            return IR_OR;
+        case IR_STRI2INTS:
+            return IR_STRI2INT;
+        case IR_NOTS:
+            *arity = 1;
+            return IR_NOT;
+        case IR_INT2FLOATS:
+            *arity = 1;
+            return IR_INT2FLOAT;
+        case IR_FLOAT2INTS:
+            *arity = 1;
+            return IR_FLOAT2INT;
+        case IR_INT2CHARS:
+            *arity = 1;
+            return IR_INT2CHAR;
+        case IR_POPS:
+            // POPS GF@%tmp2, POPS GF@%tmp1, CONCAT GF@%tmp0 GF@%tmp1 GF@%tmp2, PUSHS GF@%tmp0
+            if (i + 3 < count && strcmp(code[i].args[0].text, "GF@%tmp2") == 0
+                && code[i + 1].op == IR_POPS && strcmp(code[i + 1].args[0].text, "GF@%tmp1") == 0
+                && code[i + 2].op == IR_CONCAT && strcmp(code[i + 2].args[0].text, "GF@%tmp0") == 0
+                && strcmp(code[i + 2].args[1].text, "GF@%tmp1") == 0 && strcmp(code[i + 2].args[2].text, "GF@%tmp2") == 0
+                && code[i + 3].op == IR_PUSHS && strcmp(code[i + 3].args[0].text, "GF@%tmp0") == 0) {
+                *len = 4;
+                return IR_CONCAT;
+            }
+            return IR_OPCODE_COUNT;
+        default:
+            return IR_OPCODE_COUNT;
+    }
+}
+
+/**
+ * Rewrites a stack operation on pending operands into its direct form, the result goes
+ * straight into the variable it is popped to or into a free register that stays pending.
+ * Returns the number of instructions used, 0 if code[i] was not rewritten, -1 on error.
+ */
+static int fuse(state_t *s, ir_instr *code, unsigned int i, unsigned int count) {
+    unsigned int arity, len;
+    ir_opcode op = direct_op(code, i, count, &arity, &len);
+    if (op == IR_OPCODE_COUNT || s->count < arity)
+        return 0;
+
+    const ir_operand *b = &s->pending[s->count - 1];
+    const ir_operand *a = arity == 2 ? &s->pending[s->count - 2] : b;
+    unsigned int j = i + len; // next instruction
+    const ir_operand *dst;
+    unsigned int next_arity, next_len;
+    if (j < count && code[j].op == IR_POPS && direct_op(code, j, count, &next_arity, &next_len) == IR_OPCODE_COUNT) {
+        dst = &code[j].args[0];
+        j++;
+    }
+    else {
+        dst = free_reg(s);
+        if (dst == NULL)
+            return 0; // left on the stack
+    }
+
+    ir_operand ops[2] = { *a, *b };
+    s->count -= arity;
+    if (!flush_if_used(s, dst))
+        return -1;
+    if (!emit(s, op, arity + 1, dst, &ops[0], &ops[1]))
+        return -1;
+    if (dst >= regs && dst < regs + PEEPHOLE_REGS)
+        s->pending[s->count++] = *dst;
+    return j - i;
+}
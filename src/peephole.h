@@ -0,0 +1,29 @@
+/**
+ * Project name: Imperative language IFJ20 compiler implementation
+ * Název projektu: Implementace překladače imperativního jazyka IFJ20
+ *
+ * @brief Peephole optimizer interface
+ *
+ * @author Daniel Moudrý <xmoudr01 at stud.fit.vutbr.cz>
+ */
+
+#ifndef _PEEPHOLE_H
+#define _PEEPHOLE_H
+
+#include "ir.h"
+
+#define PEEPHOLE_REGS 4 // Global GF@%reg0.. variables for intermediate results, declared in the output header
+
+/**
+ * @brief Rewrites the stack code of a function into direct instructions
+ *
+ * Pushes are followed through each basic block, a pushed operand that is popped
+ * becomes a MOVE and an operator on pushed operands becomes its three-operand
+ * form. A stack jump on two pushed operands becomes a jump on the operands.
+ * Blocks that are neither jumped to nor fallen into are dropped.
+ *
+ * @return false if there was an error
+ */
+bool peephole(ir_list *code);
+
+#endif
@@ -0,0 +1,192 @@
+/**
+ * Project name: Imperative language IFJ20 compiler implementation
+ * Název projektu: Implementace překladače imperativního jazyka IFJ20
+ *
+ * @brief Rope (chain of chunks) implementation for the generated code
+ *
+ * @author Petr Kabelka <xkabel09 at stud.fit.vutbr.cz>
+ */
+
+#define _XOPEN_SOURCE 700
+
+#include <errno.h>
+#include <limits.h>
+#include <sys/uio.h>
+#include "rope.h"
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+bool rope_init(rope *r)
+{
+    r->first = NULL;
+    r->last = NULL;
+    r->len = 0;
+    return true;
+}
+
+void rope_free(rope *r)
+{
+    rope_chunk *chunk = r->first;
+    while (chunk != NULL)
+    {
+        rope_chunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    rope_init(r);
+}
+
+void rope_clear(rope *r)
+{
+    rope_free(r);
+}
+
+bool rope_add_len(rope *r, const char *s, size_t len)
+{
+    if (len == 0)
+    {
+        return true;
+    }
+
+    rope_chunk *chunk = r->last;
+    if (chunk != NULL && chunk->size - chunk->len >= len)
+    {
+        memcpy(chunk->data + chunk->len, s, len);
+        chunk->len += len;
+        r->len += len;
+        return true;
+    }
+
+    // fill the rest of the last chunk and start a new one
+    if (chunk != NULL)
+    {
+        size_t rest = chunk->size - chunk->len;
+        memcpy(chunk->data + chunk->len, s, rest);
+        chunk->len += rest;
+        r->len += rest;
+        s += rest;
+        len -= rest;
+    }
+
+    size_t size = len > ROPE_CHUNK_SIZE ? len : ROPE_CHUNK_SIZE;
+    if ((chunk = malloc(sizeof(rope_chunk) + size)) == NULL)
+    {
+        return false;
+    }
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->len = len;
+    memcpy(chunk->data, s, len);
+
+    if (r->last == NULL)
+    {
+        r->first = chunk;
+    }
+    else
+    {
+        r->last->next = chunk;
+    }
+    r->last = chunk;
+    r->len += len;
+    return true;
+}
+
+bool rope_add_const(rope *r, const char *s)
+{
+    return rope_add_len(r, s, strlen(s));
+}
+
+bool rope_add_var(rope *r, ...)
+{
+    va_list ap;
+    va_start(ap, r);
+    char *s;
+    while ((s = va_arg(ap, char *)) != NULL)
+    {
+        if (!rope_add_len(r, s, strlen(s)))
+        {
+            va_end(ap);
+            return false;
+        }
+    }
+    va_end(ap);
+    return true;
+}
+
+void rope_splice(rope *dst, rope *src)
+{
+    if (src->first == NULL)
+    {
+        return;
+    }
+
+    if (dst->last == NULL)
+    {
+        dst->first = src->first;
+    }
+    else
+    {
+        dst->last->next = src->first;
+    }
+    dst->last = src->last;
+    dst->len += src->len;
+    rope_init(src);
+}
+
+void rope_swap(rope *r1, rope *r2)
+{
+    rope tmp = *r1;
+    *r1 = *r2;
+    *r2 = tmp;
+}
+
+bool rope_write(rope *r, int fd)
+{
+    struct iovec iov[IOV_MAX];
+    rope_chunk *chunk = r->first;
+    while (chunk != NULL)
+    {
+        // gather up to IOV_MAX chunks
+        int cnt = 0;
+        for (; chunk != NULL && cnt < IOV_MAX; chunk = chunk->next)
+        {
+            if (chunk->len == 0)
+            {
+                continue;
+            }
+            iov[cnt].iov_base = chunk->data;
+            iov[cnt].iov_len = chunk->len;
+            cnt++;
+        }
+
+        // writev may write less than asked for
+        struct iovec *pos = iov;
+        while (cnt > 0)
+        {
+            ssize_t written = writev(fd, pos, cnt);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+
+            while (cnt > 0 && (size_t)written >= pos->iov_len)
+            {
+                written -= pos->iov_len;
+                pos++;
+                cnt--;
+            }
+            if (cnt > 0)
+            {
+                pos->iov_base = (char*)pos->iov_base + written;
+                pos->iov_len -= written;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,108 @@
+/**
+ * Project name: Imperative language IFJ20 compiler implementation
+ * Název projektu: Implementace překladače imperativního jazyka IFJ20
+ *
+ * @brief Rope (chain of chunks) interface for the generated code
+ *
+ * Text is appended into fixed size chunks that are never moved, so ropes
+ * can be spliced together by relinking their chunks instead of copying.
+ *
+ * @author Petr Kabelka <xkabel09 at stud.fit.vutbr.cz>
+ */
+
+#ifndef _ROPE_H
+#define _ROPE_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#define ROPE_CHUNK_SIZE 4096 // Default chunk capacity, longer appends get a chunk of their own size
+
+/**
+ * @struct Chunk of a rope
+ */
+typedef struct rope_chunk
+{
+    struct rope_chunk *next;
+    unsigned int len; // Used bytes
+    unsigned int size; // Capacity of data
+    char data[];
+} rope_chunk;
+
+/**
+ * @struct Rope
+ */
+typedef struct
+{
+    rope_chunk *first;
+    rope_chunk *last;
+    size_t len; // Total length of all chunks
+} rope;
+
+/**
+ * @brief Initializes an empty rope
+ * @param r Pointer to the rope structure
+ * @return True upon successful initialization
+ */
+bool rope_init(rope *r);
+
+/**
+ * @brief Frees all chunks of the rope
+ */
+void rope_free(rope *r);
+
+/**
+ * @brief Clears the rope content, same as rope_free
+ */
+void rope_clear(rope *r);
+
+/**
+ * @brief Appends len bytes of s to the rope
+ * @param r Pointer to the rope structure
+ * @param s Appended characters, need not be null terminated
+ * @param len Number of appended characters
+ * @return True upon successful append
+ */
+bool rope_add_len(rope *r, const char *s, size_t len);
+
+/**
+ * @brief Appends a string literal to the rope
+ * @param r Pointer to the rope structure
+ * @param s Appended string literal
+ * @return True upon successful append
+ */
+bool rope_add_const(rope *r, const char *s);
+
+/**
+ * @brief Appends multiple string literals to the rope
+ * @param r Pointer to the rope structure
+ * @param ... unlimited parameters of type char *, last parameter MUST be NULL
+ * @return True upon successful append
+ */
+bool rope_add_var(rope *r, ...);
+
+/**
+ * @brief Moves all chunks of src to the end of dst without copying, src is left empty
+ * @param dst Pointer to the destination rope
+ * @param src Pointer to the spliced rope
+ */
+void rope_splice(rope *dst, rope *src);
+
+/**
+ * @brief Swaps the two ropes
+ * @param r1 Pointer to the first rope
+ * @param r2 Pointer to the second rope
+ */
+void rope_swap(rope *r1, rope *r2);
+
+/**
+ * @brief Writes the rope content to a file descriptor using writev
+ * @param r Pointer to the rope structure
+ * @param fd File descriptor
+ * @return True if everything was written
+ */
+bool rope_write(rope *r, int fd);
+
+#endif
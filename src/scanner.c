@@ -7,13 +7,215 @@
  * @author Petr Kabelka <xkabel09 at stud.fit.vutbr.cz>
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "error.h"
 #include "scanner.h"
 
+#define INPUT_READ_CHUNK 65536 // Initial size of the stdin read buffer
+
+/**
+ * @struct Scanner input
+ *
+ * The whole source is kept in memory, either read from stdin with large
+ * fread calls or mapped from a file, and the scanner walks it with pos.
+ */
+static struct
+{
+    char *buf;
+    size_t len;
+    size_t pos;
+    int line; // Line of the next token
+    bool mapped; // buf was mapped with mmap, else it was allocated with malloc
+} input;
+
+/**
+ * Scratch string for the characters of the token being scanned. It is reused
+ * by all tokens so scanning a token does not allocate.
+ */
+static string scratch;
+
+/**
+ * @brief Returns the next input character or EOF at the end of the input
+ *
+ * Reading past the end still moves pos forward so unget_char stays symmetric.
+ */
+static inline int next_char()
+{
+    if (input.pos < input.len)
+    {
+        return (unsigned char)input.buf[input.pos++];
+    }
+    input.pos++;
+    return EOF;
+}
+
+/**
+ * @brief Returns the last read character back to the input
+ */
+static inline void unget_char()
+{
+    input.pos--;
+}
+
+/**
+ * @brief Reads the whole stream f into the input buffer
+ * @param f Input stream
+ * @return SCANNER_SUCCESS, else ERR_INTERNAL
+ */
+static int read_stream(FILE *f)
+{
+    size_t size = INPUT_READ_CHUNK;
+    char *buf = malloc(size);
+    if (buf == NULL)
+    {
+        return ERR_INTERNAL;
+    }
+
+    size_t len = 0;
+    size_t n;
+    while ((n = fread(buf + len, 1, size - len, f)) > 0)
+    {
+        len += n;
+        if (len == size)
+        {
+            char *tmp = realloc(buf, size * 2);
+            if (tmp == NULL)
+            {
+                free(buf);
+                return ERR_INTERNAL;
+            }
+            buf = tmp;
+            size *= 2;
+        }
+    }
+
+    if (ferror(f))
+    {
+        free(buf);
+        return ERR_INTERNAL;
+    }
+
+    input.buf = buf;
+    input.len = len;
+    input.pos = 0;
+    input.mapped = false;
+    return SCANNER_SUCCESS;
+}
+
+/**
+ * @brief Maps the file at path into the input buffer
+ * @return SCANNER_SUCCESS, else ERR_INTERNAL
+ */
+static int map_file(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return ERR_INTERNAL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return ERR_INTERNAL;
+    }
+
+    if (!S_ISREG(st.st_mode))
+    {
+        // pipes and devices cannot be mapped, they are read like stdin
+        FILE *f = fdopen(fd, "r");
+        if (f == NULL)
+        {
+            close(fd);
+            return ERR_INTERNAL;
+        }
+        int result = read_stream(f);
+        fclose(f);
+        return result;
+    }
+
+    input.len = (size_t)st.st_size;
+    input.pos = 0;
+    input.mapped = input.len > 0;
+    if (!input.mapped)
+    {
+        // mmap does not accept zero length, an empty file is an empty buffer
+        close(fd);
+        input.buf = malloc(1);
+        return input.buf == NULL ? ERR_INTERNAL : SCANNER_SUCCESS;
+    }
+
+    input.buf = mmap(NULL, input.len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (input.buf == MAP_FAILED)
+    {
+        input.buf = NULL;
+        return ERR_INTERNAL;
+    }
+    posix_madvise(input.buf, input.len, POSIX_MADV_SEQUENTIAL);
+    return SCANNER_SUCCESS;
+}
+
+int scanner_open(const char *path)
+{
+    scanner_close();
+    if (!str_init(&scratch))
+    {
+        return ERR_INTERNAL;
+    }
+
+    int result = path == NULL ? read_stream(stdin) : map_file(path);
+    if (result != SCANNER_SUCCESS)
+    {
+        str_free(&scratch);
+    }
+    input.line = 1;
+    return result;
+}
+
+scanner_pos scanner_tell()
+{
+    scanner_pos p = { input.pos, input.line };
+    return p;
+}
+
+void scanner_seek(scanner_pos p)
+{
+    input.pos = p.pos;
+    input.line = p.line;
+}
+
+void scanner_close()
+{
+    if (input.buf == NULL)
+    {
+        return;
+    }
+
+    str_free(&scratch);
+    if (input.mapped)
+    {
+        munmap(input.buf, input.len);
+    }
+    else
+    {
+        free(input.buf);
+    }
+    input.buf = NULL;
+    input.len = 0;
+    input.pos = 0;
+}
+
 /**
- * @brief Frees dynamic string and returns given exit code
+ * @brief Clears dynamic string and returns given exit code
  *
  * This function serves purpose to cut down on lines when exiting get_next_token
  *
@@ -23,27 +225,106 @@
  */
 static int cleanup(string *str, int code)
 {
-    str_free(str);
+    str_clear(str);
     return code;
 }
 
 /**
- * @brief Frees dynamic string, ungets the char c to stdin and returns given exit code
+ * @brief Clears dynamic string, returns the last read char to the input and returns given exit code
  *
  * This function serves purpose to cut down on lines when exiting get_next_token
  *
  * @param str Pointer to a dynamic string
  * @param code Exit code
- * @param c Character to ungetc
  * @return Given exit code
  */
-static int cleanup_c(string *str, int code, char c)
+static int cleanup_c(string *str, int code)
 {
-    ungetc(c, stdin);
-    str_free(str);
+    unget_char();
+    str_clear(str);
     return code;
 }
 
+/**
+ * @brief Compares str to keyword spelling s and sets kw on match
+ *
+ * Used by keyword_lookup once the length and the first character already
+ * narrowed the candidates down, so only the rest of the spelling is compared.
+ */
+#define KW_CMP(s, k) if (memcmp(str + 1, (s) + 1, len - 1) == 0) { *kw = (k); return true; }
+
+bool keyword_lookup(const char *str, unsigned int len, keyword *kw)
+{
+    switch (len)
+    {
+        case 1:
+            if (str[0] == '_') { *kw = KW_UNDERSCORE; return true; }
+            break;
+        case 2:
+            if (str[0] == 'i') { KW_CMP("if", KW_IF) }
+            break;
+        case 3:
+            switch (str[0])
+            {
+                case 'c': KW_CMP("chr", KW_CHR) break;
+                case 'f': KW_CMP("for", KW_FOR) break;
+                case 'i': KW_CMP("int", KW_INT) break;
+                case 'l': KW_CMP("len", KW_LEN) break;
+                case 'n': KW_CMP("nil", KW_NIL) break;
+                case 'o': KW_CMP("ord", KW_ORD) break;
+            }
+            break;
+        case 4:
+            switch (str[0])
+            {
+                case 'e': KW_CMP("else", KW_ELSE) break;
+                case 'f': KW_CMP("func", KW_FUNC) break;
+            }
+            break;
+        case 5:
+            if (str[0] == 'p') { KW_CMP("print", KW_PRINT) }
+            break;
+        case 6:
+            switch (str[0])
+            {
+                case 'i':
+                    // inputs, inputi and inputf differ only in the last character
+                    if (memcmp(str, "input", 5) == 0)
+                    {
+                        switch (str[5])
+                        {
+                            case 's': *kw = KW_INPUTS; return true;
+                            case 'i': *kw = KW_INPUTI; return true;
+                            case 'f': *kw = KW_INPUTF; return true;
+                        }
+                    }
+                    break;
+                case 'r': KW_CMP("return", KW_RETURN) break;
+                case 's':
+                    // string and substr differ in the second character
+                    if (str[1] == 't') { KW_CMP("string", KW_STRING) }
+                    else if (str[1] == 'u') { KW_CMP("substr", KW_SUBSTR) }
+                    break;
+            }
+            break;
+        case 7:
+            switch (str[0])
+            {
+                case 'f': KW_CMP("float64", KW_FLOAT64) break;
+                case 'p': KW_CMP("package", KW_PACKAGE) break;
+            }
+            break;
+        case 9:
+            switch (str[0])
+            {
+                case 'f': KW_CMP("float2int", KW_FLOAT2INT) break;
+                case 'i': KW_CMP("int2float", KW_INT2FLOAT) break;
+            }
+            break;
+    }
+    return false;
+}
+
 /**
  * @brief Checks scanned identifier if it is actually a keyword or identifier
  * 
@@ -54,32 +335,14 @@ static int cleanup_c(string *str, int code, char c)
  */
 static int keyword_or_identifier(token *tok, string *str)
 {
-    if (str_cmp_const(str, "int") == 0)            { tok->attr.kw = KW_INT; }
-    else if (str_cmp_const(str, "float64") == 0)   { tok->attr.kw = KW_FLOAT64; }
-    else if (str_cmp_const(str, "string") == 0)    { tok->attr.kw = KW_STRING; }
-    else if (str_cmp_const(str, "nil") == 0)       { tok->attr.kw = KW_NIL; }
-    else if (str_cmp_const(str, "_") == 0)         { tok->attr.kw = KW_UNDERSCORE; }
-    else if (str_cmp_const(str, "if") == 0)        { tok->attr.kw = KW_IF; }
-    else if (str_cmp_const(str, "else") == 0)      { tok->attr.kw = KW_ELSE; }
-    else if (str_cmp_const(str, "for") == 0)       { tok->attr.kw = KW_FOR; }
-    else if (str_cmp_const(str, "package") == 0)   { tok->attr.kw = KW_PACKAGE; }
-    else if (str_cmp_const(str, "func") == 0)      { tok->attr.kw = KW_FUNC; }
-    else if (str_cmp_const(str, "return") == 0)    { tok->attr.kw = KW_RETURN; }
-    else if (str_cmp_const(str, "print") == 0)     { tok->attr.kw = KW_PRINT; }
-    else if (str_cmp_const(str, "inputs") == 0)    { tok->attr.kw = KW_INPUTS; }
-    else if (str_cmp_const(str, "inputi") == 0)    { tok->attr.kw = KW_INPUTI; }
-    else if (str_cmp_const(str, "inputf") == 0)    { tok->attr.kw = KW_INPUTF; }
-    else if (str_cmp_const(str, "int2float") == 0) { tok->attr.kw = KW_INT2FLOAT; }
-    else if (str_cmp_const(str, "float2int") == 0) { tok->attr.kw = KW_FLOAT2INT; }
-    else if (str_cmp_const(str, "len") == 0)       { tok->attr.kw = KW_LEN; }
-    else if (str_cmp_const(str, "substr") == 0)    { tok->attr.kw = KW_SUBSTR; }
-    else if (str_cmp_const(str, "ord") == 0)       { tok->attr.kw = KW_ORD; }
-    else if (str_cmp_const(str, "chr") == 0)       { tok->attr.kw = KW_CHR; }
-    else { tok->type = TOKEN_IDENTIFIER; }
-
-    if (tok->type == TOKEN_KEYWORD) { return cleanup(str, SCANNER_SUCCESS); }
-
-    if (!str_copy(str, tok->attr.str)) { return cleanup(str, ERR_INTERNAL); }
+    if (keyword_lookup(str->str, str->len, &tok->attr.kw))
+    {
+        tok->type = TOKEN_KEYWORD;
+        return cleanup(str, SCANNER_SUCCESS);
+    }
+
+    tok->type = TOKEN_IDENTIFIER;
+    if ((tok->attr.id = atom_intern(str->str, str->len)) == NULL) { return cleanup(str, ERR_INTERNAL); }
     return cleanup(str, SCANNER_SUCCESS);
 }
 
@@ -132,16 +395,12 @@ void set_token_string_attr(string *s)
 
 int get_next_token(token *tok)
 {
-    string str;
-    if (!str_init(&str))
+    if (input.buf == NULL && scanner_open(NULL) != SCANNER_SUCCESS)
     {
         return ERR_INTERNAL;
     }
 
-    /**
-     * Keeps track of the token line number
-     */
-    static int line = 1;
+    string *str = &scratch;
 
     // set the token attribute str pointer to an initialized dynamic string
     tok->attr.str = token_string_attr;
@@ -152,11 +411,11 @@ int get_next_token(token *tok)
     int c_prev = 0;
     char hex_escape_str[3];
     unsigned int int_base = 10;
-    tok->line = line;
+    tok->line = input.line;
 
     while(1)
     {
-        c = getchar();
+        c = next_char();
         switch (state)
         {
             case SCANNER_START:
@@ -174,7 +433,7 @@ int get_next_token(token *tok)
                         break;
                     case EOF:
                         tok->type = TOKEN_EOF;
-                        return cleanup(&str, SCANNER_SUCCESS);
+                        return cleanup(str, SCANNER_SUCCESS);
                     case '/':
                         state = SCANNER_COMMENT_OR_DIV;
                         break;
@@ -195,31 +454,31 @@ int get_next_token(token *tok)
                         break;
                     case '+':
                         tok->type = TOKEN_ADD;
-                        return cleanup(&str, SCANNER_SUCCESS);
+                        return cleanup(str, SCANNER_SUCCESS);
                     case '-':
                         tok->type = TOKEN_SUB;
-                        return cleanup(&str, SCANNER_SUCCESS);
+                        return cleanup(str, SCANNER_SUCCESS);
                     case '*':
                         tok->type = TOKEN_MUL;
-                        return cleanup(&str, SCANNER_SUCCESS);
+                        return cleanup(str, SCANNER_SUCCESS);
                     case '(':
                         tok->type = TOKEN_PAR_OPEN;
-                        return cleanup(&str, SCANNER_SUCCESS);
+                        return cleanup(str, SCANNER_SUCCESS);
                     case ')':
                         tok->type = TOKEN_PAR_CLOSE;
-                        return cleanup(&str, SCANNER_SUCCESS);
+                        return cleanup(str, SCANNER_SUCCESS);
                     case '{':
                         tok->type = TOKEN_CURLY_OPEN;
-                        return cleanup(&str, SCANNER_SUCCESS);
+                        return cleanup(str, SCANNER_SUCCESS);
                     case '}':
                         tok->type = TOKEN_CURLY_CLOSE;
-                        return cleanup(&str, SCANNER_SUCCESS);
+                        return cleanup(str, SCANNER_SUCCESS);
                     case ';':
                         tok->type = TOKEN_SEMICOLON;
-                        return cleanup(&str, SCANNER_SUCCESS);
+                        return cleanup(str, SCANNER_SUCCESS);
                     case ',':
                         tok->type = TOKEN_COMMA;
-                        return cleanup(&str, SCANNER_SUCCESS);
+                        return cleanup(str, SCANNER_SUCCESS);
                     // isalpha(c) || c == '_'
                     case 'a':case 'b':case 'c':case 'd':case 'e':case 'f':
                     case 'g':case 'h':case 'i':case 'j':case 'k':case 'l':
@@ -230,7 +489,7 @@ int get_next_token(token *tok)
                     case 'K':case 'L':case 'M':case 'N':case 'O':case 'P':
                     case 'Q':case 'R':case 'S':case 'T':case 'U':case 'V':
                     case 'W':case 'X':case 'Y':case 'Z':case '_':
-                        if (!str_add(&str, c)) { return cleanup(&str, ERR_INTERNAL); }
+                        if (!str_add(str, c)) { return cleanup(str, ERR_INTERNAL); }
                         state = SCANNER_KEYWORD_OR_IDENTIFIER;
                         break;
                     case '0':
@@ -240,7 +499,7 @@ int get_next_token(token *tok)
                     // rest of isdigit(c)
                     case '1':case '2':case '3':case '4':case '5':
                     case '6':case '7':case '8':case '9':
-                        if (!str_add(&str, c)) { return cleanup(&str, ERR_INTERNAL); }
+                        if (!str_add(str, c)) { return cleanup(str, ERR_INTERNAL); }
                         c_prev = c;
                         state = SCANNER_INT;
                         break;
@@ -248,7 +507,7 @@ int get_next_token(token *tok)
                         state = SCANNER_STRING;
                         break;
                     default:
-                        return cleanup(&str, ERR_LEX_STRUCTURE);
+                        return cleanup(str, ERR_LEX_STRUCTURE);
                 }
                 break;
 
@@ -256,7 +515,7 @@ int get_next_token(token *tok)
                 switch (c)
                 {
                     case '\n':
-                        line += 1;
+                        input.line += 1;
                         break;
                     // rest of isspace(c)
                     case ' ':
@@ -267,8 +526,8 @@ int get_next_token(token *tok)
                         break;
                     default:
                         tok->type = TOKEN_EOL;
-                        line += 1;
-                        return cleanup_c(&str, SCANNER_SUCCESS, c);
+                        input.line += 1;
+                        return cleanup_c(str, SCANNER_SUCCESS);
                 }
                 break;
 
@@ -284,7 +543,7 @@ int get_next_token(token *tok)
                 else
                 {
                     tok->type = TOKEN_DIV;
-                    return cleanup_c(&str, SCANNER_SUCCESS, c);
+                    return cleanup_c(str, SCANNER_SUCCESS);
                 }
                 break;
 
@@ -292,14 +551,14 @@ int get_next_token(token *tok)
                 if (c == '\n' || c == EOF)
                 {
                     state = SCANNER_START;
-                    ungetc(c, stdin);
+                    unget_char();
                 }
                 break;
 
             case SCANNER_COMMENT_START:
                 if (c == '\n')
                 {
-                    line += 1;
+                    input.line += 1;
                 }
                 else if (c == '*')
                 {
@@ -307,14 +566,14 @@ int get_next_token(token *tok)
                 }
                 else if (c == EOF)
                 {
-                    return cleanup(&str, ERR_LEX_STRUCTURE);
+                    return cleanup(str, ERR_LEX_STRUCTURE);
                 }
                 break;
 
             case SCANNER_COMMENT_END:
                 if (c == EOF)
                 {
-                    return cleanup(&str, ERR_LEX_STRUCTURE);
+                    return cleanup(str, ERR_LEX_STRUCTURE);
                 }
                 else if (c == '/')
                 {
@@ -326,11 +585,11 @@ int get_next_token(token *tok)
                 if (c == '=')
                 {
                     tok->type = TOKEN_ASSIGN;
-                    return cleanup(&str, SCANNER_SUCCESS);
+                    return cleanup(str, SCANNER_SUCCESS);
                 }
                 else
                 {
-                    return cleanup(&str, ERR_LEX_STRUCTURE);
+                    return cleanup(str, ERR_LEX_STRUCTURE);
                 }
                 break;
 
@@ -338,12 +597,12 @@ int get_next_token(token *tok)
                 if (c == '=')
                 {
                     tok->type = TOKEN_EQUAL;
-                    return cleanup(&str, SCANNER_SUCCESS);
+                    return cleanup(str, SCANNER_SUCCESS);
                 }
                 else
                 {
                     tok->type = TOKEN_REASSIGN;
-                    return cleanup_c(&str, SCANNER_SUCCESS, c);
+                    return cleanup_c(str, SCANNER_SUCCESS);
                 }
                 break;
 
@@ -351,11 +610,11 @@ int get_next_token(token *tok)
                 if (c == '=')
                 {
                     tok->type = TOKEN_NOT_EQUAL;
-                    return cleanup(&str, SCANNER_SUCCESS);
+                    return cleanup(str, SCANNER_SUCCESS);
                 }
                 else
                 {
-                    return cleanup(&str, ERR_LEX_STRUCTURE);
+                    return cleanup(str, ERR_LEX_STRUCTURE);
                 }
                 break;
 
@@ -363,12 +622,12 @@ int get_next_token(token *tok)
                 if (c == '=')
                 {
                     tok->type = TOKEN_LESS_OR_EQUAL;
-                    return cleanup(&str, SCANNER_SUCCESS);
+                    return cleanup(str, SCANNER_SUCCESS);
                 }
                 else
                 {
                     tok->type = TOKEN_LESS_THAN;
-                    return cleanup_c(&str, SCANNER_SUCCESS, c);
+                    return cleanup_c(str, SCANNER_SUCCESS);
                 }
                 break;
 
@@ -376,61 +635,63 @@ int get_next_token(token *tok)
                 if (c == '=')
                 {
                     tok->type = TOKEN_GREATER_OR_EQUAL;
-                    return cleanup(&str, SCANNER_SUCCESS);
+                    return cleanup(str, SCANNER_SUCCESS);
                 }
                 else
                 {
                     tok->type = TOKEN_GREATER_THAN;
-                    return cleanup_c(&str, SCANNER_SUCCESS, c);
+                    return cleanup_c(str, SCANNER_SUCCESS);
                 }
                 break;
 
             case SCANNER_KEYWORD_OR_IDENTIFIER:
                 if (isalnum(c) || c == '_')
                 {
-                    if (!str_add(&str, c)) { return cleanup(&str, ERR_INTERNAL); }
+                    // take the rest of the identifier straight from the input buffer
+                    size_t start = input.pos - 1;
+                    while (input.pos < input.len && (isalnum((unsigned char)input.buf[input.pos]) || input.buf[input.pos] == '_'))
+                    {
+                        input.pos++;
+                    }
+                    if (!str_add_len(str, input.buf + start, (unsigned int)(input.pos - start))) { return cleanup(str, ERR_INTERNAL); }
                 }
                 else
                 {
-                    ungetc(c, stdin);
-                    // We "predict" the token is a keyword, if it is an identifier
-                    // it will be set as TOKEN_IDENTIFIER in the
-                    // keyword_or_identifier function
-                    tok->type = TOKEN_KEYWORD;
-                    return keyword_or_identifier(tok, &str);
+                    unget_char();
+                    return keyword_or_identifier(tok, str);
                 }
                 break;
 
             case SCANNER_INT:
                 if (isdigit(c))
                 {
-                    if (!str_add(&str, c)) { return cleanup(&str, ERR_INTERNAL); }
+                    if (!str_add(str, c)) { return cleanup(str, ERR_INTERNAL); }
                 }
                 else if (c == '.')
                 {
                     state = SCANNER_DECIMAL_POINT;
-                    if (!str_add(&str, c)) { return cleanup(&str, ERR_INTERNAL); }
+                    if (!str_add(str, c)) { return cleanup(str, ERR_INTERNAL); }
                 }
                 else if (c == 'e' || c == 'E')
                 {
                     state = SCANNER_FLOAT64_EXPONENT;
-                    if (!str_add(&str, c)) { return cleanup(&str, ERR_INTERNAL); }
+                    if (!str_add(str, c)) { return cleanup(str, ERR_INTERNAL); }
                 }
                 else if (c == '_')
                 {
                     if (!isdigit(c_prev))
                     {
-                        return cleanup(&str, ERR_LEX_STRUCTURE);
+                        return cleanup(str, ERR_LEX_STRUCTURE);
                     }
                 }
                 else
                 {
                     if (c_prev == '_')
                     {
-                        return cleanup_c(&str, ERR_LEX_STRUCTURE, c);
+                        return cleanup_c(str, ERR_LEX_STRUCTURE);
                     }
-                    ungetc(c, stdin);
-                    return tok_attr_int(tok, &str, 10);
+                    unget_char();
+                    return tok_attr_int(tok, str, 10);
                 }
                 c_prev = c;
                 break;
@@ -451,33 +712,33 @@ int get_next_token(token *tok)
                         state = SCANNER_INT_BASE_NUM_FIRST;
                         break;
                     case '0':
-                        return cleanup(&str, ERR_LEX_STRUCTURE);
+                        return cleanup(str, ERR_LEX_STRUCTURE);
                     // rest of isdigit(c)
                     case '1':case '2':case '3':case '4':case '5':
                     case '6':case '7':case '8':case '9':
                         int_base = 8;
                         state = SCANNER_INT_BASE_NUM_OTHER;
-                        if (!str_add(&str, c)) { return cleanup(&str, ERR_INTERNAL); }
+                        if (!str_add(str, c)) { return cleanup(str, ERR_INTERNAL); }
                         break;
                     case '.':
                         state = SCANNER_DECIMAL_POINT;
-                        if (!str_add(&str, '0')) { return cleanup(&str, ERR_INTERNAL); }
-                        if (!str_add(&str, c)) { return cleanup(&str, ERR_INTERNAL); }
+                        if (!str_add(str, '0')) { return cleanup(str, ERR_INTERNAL); }
+                        if (!str_add(str, c)) { return cleanup(str, ERR_INTERNAL); }
                         break;
                     case '_':
                         int_base = 8;
-                        ungetc(c, stdin);
+                        unget_char();
                         state = SCANNER_INT_BASE_NUM_FIRST;
                         break;
                     case 'e': case 'E':
                         state = SCANNER_FLOAT64_EXPONENT;
-                        if (!str_add(&str, '0')) { return cleanup(&str, ERR_INTERNAL); }
-                        if (!str_add(&str, c)) { return cleanup(&str, ERR_INTERNAL); }
+                        if (!str_add(str, '0')) { return cleanup(str, ERR_INTERNAL); }
+                        if (!str_add(str, c)) { return cleanup(str, ERR_INTERNAL); }
                         break;
                     default:
                         tok->type = TOKEN_INT;
                         tok->attr.int_val = 0;
-                        return cleanup_c(&str, SCANNER_SUCCESS, c);
+                        return cleanup_c(str, SCANNER_SUCCESS);
                         break;
                 }
                 break;
@@ -485,23 +746,23 @@ int get_next_token(token *tok)
             case SCANNER_INT_BASE_NUM_FIRST:
                 if (c == '0')
                 {
-                    return cleanup(&str, ERR_LEX_STRUCTURE);
+                    return cleanup(str, ERR_LEX_STRUCTURE);
                 }
                 else if (isdigit(c) || (int_base == 16 && ((c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'))))
                 {
                     state = SCANNER_INT_BASE_NUM_OTHER;
-                    if (!str_add(&str, c)) { return cleanup(&str, ERR_INTERNAL); }
+                    if (!str_add(str, c)) { return cleanup(str, ERR_INTERNAL); }
                 }
                 else if (c == '_')
                 {
                     if (!isdigit(c_prev))
                     {
-                        return cleanup(&str, ERR_LEX_STRUCTURE);
+                        return cleanup(str, ERR_LEX_STRUCTURE);
                     }
                 }
                 else
                 {
-                    return cleanup(&str, ERR_LEX_STRUCTURE);
+                    return cleanup(str, ERR_LEX_STRUCTURE);
                 }
                 c_prev = c;
                 break;
@@ -509,23 +770,23 @@ int get_next_token(token *tok)
             case SCANNER_INT_BASE_NUM_OTHER:
                 if (isdigit(c) || (int_base == 16 && ((c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'))))
                 {
-                    if (!str_add(&str, c)) { return cleanup(&str, ERR_INTERNAL); }
+                    if (!str_add(str, c)) { return cleanup(str, ERR_INTERNAL); }
                 }
                 else if (c == '_')
                 {
                     if (!isdigit(c_prev) && !(int_base == 16 && ((c_prev >= 'a' && c_prev <= 'f') || (c_prev >= 'A' && c_prev <= 'F'))))
                     {
-                        return cleanup(&str, ERR_LEX_STRUCTURE);
+                        return cleanup(str, ERR_LEX_STRUCTURE);
                     }
                 }
                 else
                 {
                     if (c_prev == '_')
                     {
-                        return cleanup_c(&str, ERR_LEX_STRUCTURE, c);
+                        return cleanup_c(str, ERR_LEX_STRUCTURE);
                     }
-                    ungetc(c, stdin);
-                    return tok_attr_int(tok, &str, int_base);
+                    unget_char();
+                    return tok_attr_int(tok, str, int_base);
                 }
                 c_prev = c;
                 break;
@@ -534,39 +795,39 @@ int get_next_token(token *tok)
                 if (isdigit(c))
                 {
                     state = SCANNER_FLOAT64;
-                    if (!str_add(&str, c)) { return cleanup(&str, ERR_INTERNAL); }
+                    if (!str_add(str, c)) { return cleanup(str, ERR_INTERNAL); }
                 }
                 else
                 {
-                    return cleanup_c(&str, ERR_LEX_STRUCTURE, c);
+                    return cleanup_c(str, ERR_LEX_STRUCTURE);
                 }
                 break;
 
             case SCANNER_FLOAT64:
                 if (isdigit(c))
                 {
-                    if (!str_add(&str, c)) { return cleanup(&str, ERR_INTERNAL); }
+                    if (!str_add(str, c)) { return cleanup(str, ERR_INTERNAL); }
                 }
                 else if (c == 'e' || c == 'E')
                 {
                     state = SCANNER_FLOAT64_EXPONENT;
-                    if (!str_add(&str, c)) { return cleanup(&str, ERR_INTERNAL); }
+                    if (!str_add(str, c)) { return cleanup(str, ERR_INTERNAL); }
                 }
                 else if (c == '_')
                 {
                     if (!isdigit(c_prev))
                     {
-                        return cleanup(&str, ERR_LEX_STRUCTURE);
+                        return cleanup(str, ERR_LEX_STRUCTURE);
                     }
                 }
                 else
                 {
                     if (c_prev == '_')
                     {
-                        return cleanup_c(&str, ERR_LEX_STRUCTURE, c);
+                        return cleanup_c(str, ERR_LEX_STRUCTURE);
                     }
-                    ungetc(c, stdin);
-                    return token_attr_float64(tok, &str);
+                    unget_char();
+                    return token_attr_float64(tok, str);
                 }
                 c_prev = c;
                 break;
@@ -575,16 +836,16 @@ int get_next_token(token *tok)
                 if (isdigit(c))
                 {
                     state = SCANNER_FLOAT64_EXPONENT_NUMBER;
-                    if (!str_add(&str, c)) { return cleanup(&str, ERR_INTERNAL); }
+                    if (!str_add(str, c)) { return cleanup(str, ERR_INTERNAL); }
                 }
                 else if (c == '+' || c == '-')
                 {
                     state = SCANNER_FLOAT64_EXPONENT_SIGN;
-                    if (!str_add(&str, c)) { return cleanup(&str, ERR_INTERNAL); }
+                    if (!str_add(str, c)) { return cleanup(str, ERR_INTERNAL); }
                 }
                 else
                 {
-                    return cleanup(&str, ERR_LEX_STRUCTURE);
+                    return cleanup(str, ERR_LEX_STRUCTURE);
                 }
                 c_prev = c;
                 break;
@@ -593,11 +854,11 @@ int get_next_token(token *tok)
                 if (isdigit(c))
                 {
                     state = SCANNER_FLOAT64_EXPONENT_NUMBER;
-                    if (!str_add(&str, c)) { return cleanup(&str, ERR_INTERNAL); }
+                    if (!str_add(str, c)) { return cleanup(str, ERR_INTERNAL); }
                 }
                 else
                 {
-                    return cleanup(&str, ERR_LEX_STRUCTURE);
+                    return cleanup(str, ERR_LEX_STRUCTURE);
                 }
                 c_prev = c;
                 break;
@@ -605,23 +866,23 @@ int get_next_token(token *tok)
             case SCANNER_FLOAT64_EXPONENT_NUMBER:
                 if (isdigit(c))
                 {
-                    if (!str_add(&str, c)) { return cleanup(&str, ERR_INTERNAL); }
+                    if (!str_add(str, c)) { return cleanup(str, ERR_INTERNAL); }
                 }
                 else if (c == '_')
                 {
                     if (!isdigit(c_prev))
                     {
-                        return cleanup(&str, ERR_LEX_STRUCTURE);
+                        return cleanup(str, ERR_LEX_STRUCTURE);
                     }
                 }
                 else
                 {
                     if (c_prev == '_')
                     {
-                        return cleanup_c(&str, ERR_LEX_STRUCTURE, c);
+                        return cleanup_c(str, ERR_LEX_STRUCTURE);
                     }
-                    ungetc(c, stdin);
-                    return token_attr_float64(tok, &str);
+                    unget_char();
+                    return token_attr_float64(tok, str);
                 }
                 c_prev = c;
                 break;
@@ -629,13 +890,13 @@ int get_next_token(token *tok)
             case SCANNER_STRING:
                 if (c < 32)
                 {
-                    return cleanup(&str, ERR_LEX_STRUCTURE);
+                    return cleanup(str, ERR_LEX_STRUCTURE);
                 }
                 else if (c == '"')
                 {
-                    if (!str_copy(&str, tok->attr.str)) { return cleanup(&str, ERR_INTERNAL); }
+                    if (!str_copy(str, tok->attr.str)) { return cleanup(str, ERR_INTERNAL); }
                     tok->type = TOKEN_STRING;
-                    return cleanup(&str, SCANNER_SUCCESS);
+                    return cleanup(str, SCANNER_SUCCESS);
                 }
                 else if (c == '\\')
                 {
@@ -643,7 +904,7 @@ int get_next_token(token *tok)
                 }
                 else
                 {
-                    if (!str_add(&str, c)) { return cleanup(&str, ERR_INTERNAL); }
+                    if (!str_add(str, c)) { return cleanup(str, ERR_INTERNAL); }
                 }
                 break;
 
@@ -651,50 +912,50 @@ int get_next_token(token *tok)
                 switch (c)
                 {
                     case 'n':
-                        if (!str_add(&str, '\n')) { return cleanup(&str, ERR_INTERNAL); }
+                        if (!str_add(str, '\n')) { return cleanup(str, ERR_INTERNAL); }
                         state = SCANNER_STRING;
                         break;
                     case 'r':
-                        if (!str_add(&str, '\r')) { return cleanup(&str, ERR_INTERNAL); }
+                        if (!str_add(str, '\r')) { return cleanup(str, ERR_INTERNAL); }
                         state = SCANNER_STRING;
                         break;
                     case 't':
-                        if (!str_add(&str, '\t')) { return cleanup(&str, ERR_INTERNAL); }
+                        if (!str_add(str, '\t')) { return cleanup(str, ERR_INTERNAL); }
                         state = SCANNER_STRING;
                         break;
                     case '\\':
-                        if (!str_add(&str, '\\')) { return cleanup(&str, ERR_INTERNAL); }
+                        if (!str_add(str, '\\')) { return cleanup(str, ERR_INTERNAL); }
                         state = SCANNER_STRING;
                         break;
                     case '"':
-                        if (!str_add(&str, '"')) { return cleanup(&str, ERR_INTERNAL); }
+                        if (!str_add(str, '"')) { return cleanup(str, ERR_INTERNAL); }
                         state = SCANNER_STRING;
                         break;
                     case '\'':
-                        if (!str_add(&str, '\'')) { return cleanup(&str, ERR_INTERNAL); }
+                        if (!str_add(str, '\'')) { return cleanup(str, ERR_INTERNAL); }
                         state = SCANNER_STRING;
                         break;
                     case 'x':
                         state = SCANNER_STRING_ESCAPE_HEX_FIRST;
                         break;
                     case 'v':
-                        if (!str_add(&str, '\v')) { return cleanup(&str, ERR_INTERNAL); }
+                        if (!str_add(str, '\v')) { return cleanup(str, ERR_INTERNAL); }
                         state = SCANNER_STRING;
                         break;
                     case 'a':
-                        if (!str_add(&str, '\a')) { return cleanup(&str, ERR_INTERNAL); }
+                        if (!str_add(str, '\a')) { return cleanup(str, ERR_INTERNAL); }
                         state = SCANNER_STRING;
                         break;
                     case 'b':
-                        if (!str_add(&str, '\b')) { return cleanup(&str, ERR_INTERNAL); }
+                        if (!str_add(str, '\b')) { return cleanup(str, ERR_INTERNAL); }
                         state = SCANNER_STRING;
                         break;
                     case 'f':
-                        if (!str_add(&str, '\f')) { return cleanup(&str, ERR_INTERNAL); }
+                        if (!str_add(str, '\f')) { return cleanup(str, ERR_INTERNAL); }
                         state = SCANNER_STRING;
                         break;
                     default:
-                        return cleanup(&str, ERR_LEX_STRUCTURE);
+                        return cleanup(str, ERR_LEX_STRUCTURE);
                         break;
                 }
                 break;
@@ -707,7 +968,7 @@ int get_next_token(token *tok)
                 }
                 else
                 {
-                    return cleanup(&str, ERR_LEX_STRUCTURE);
+                    return cleanup(str, ERR_LEX_STRUCTURE);
                 }
                 break;
 
@@ -719,12 +980,12 @@ int get_next_token(token *tok)
                     hex_escape_str[2] = '\0';
                     char *end;
                     int value = (int) strtol(hex_escape_str, &end, 16);
-                    if (*end != '\0') { return cleanup(&str, ERR_INTERNAL); }
-                    if (!str_add(&str, value)) { return cleanup(&str, ERR_INTERNAL); }
+                    if (*end != '\0') { return cleanup(str, ERR_INTERNAL); }
+                    if (!str_add(str, value)) { return cleanup(str, ERR_INTERNAL); }
                 }
                 else
                 {
-                    return cleanup(&str, ERR_LEX_STRUCTURE);
+                    return cleanup(str, ERR_LEX_STRUCTURE);
                 }
                 break;
         }
@@ -11,6 +11,7 @@
 #define _SCANNER_H
 
 #include "str.h"
+#include "atom.h"
 
 #define SCANNER_SUCCESS 0
 
@@ -118,6 +119,7 @@ typedef union
     long int int_val;
     double float64_val;
     string *str;
+    const atom *id; // Identifier name
     keyword kw;
 } token_attr;
 
@@ -131,6 +133,58 @@ typedef struct
     int line;
 } token;
 
+/**
+ * @brief Looks up the keyword spelled by the first len characters of str
+ *
+ * The candidates are selected by the length and the first character (the second
+ * one for string and substr), so an identifier is compared to at most one keyword
+ * spelling.
+ *
+ * @param str Scanned identifier
+ * @param len Length of the identifier
+ * @param kw Set to the keyword if str is one
+ * @return True if str is a keyword
+ */
+bool keyword_lookup(const char *str, unsigned int len, keyword *kw);
+
+/**
+ * @brief Opens the source the scanner reads from
+ *
+ * The whole source is made available in memory at once. With path set to NULL
+ * stdin is read with large buffered reads, otherwise the file is mapped.
+ * get_next_token opens stdin by itself if no input was opened before.
+ *
+ * @param path Path to the source file or NULL for stdin
+ * @return SCANNER_SUCCESS upon success, else ERR_INTERNAL
+ */
+int scanner_open(const char *path);
+
+/**
+ * @brief Releases the source opened by scanner_open
+ */
+void scanner_close();
+
+/**
+ * @struct Position in the scanned source
+ */
+typedef struct
+{
+    size_t pos;
+    int line;
+} scanner_pos;
+
+/**
+ * @brief Returns the position of the next token, for scanning ahead and coming back
+ */
+scanner_pos scanner_tell();
+
+/**
+ * @brief Moves the scanner back to a position returned by scanner_tell
+ *
+ * The string attribute of a string token scanned in between is overwritten.
+ */
+void scanner_seek(scanner_pos p);
+
 /**
  * @brief Sets the token attribute *str to a preallocated dynamic string pointer
  * @param s Pointer to a preallocated string
@@ -11,47 +11,59 @@
 
 void stack_init(stack *s)
 {
-    s->top = NULL;
+    s->items = NULL;
     s->count = 0;
+    s->size = 0;
 }
 
 bool stack_push(stack *s, void *data)
 {
-    struct stack_el *tmp = malloc(sizeof(struct stack_el));
-    if (tmp == NULL)
+    if (s->count == s->size)
     {
-        return false;
+        unsigned int size = s->size == 0 ? STACK_INIT_SIZE : s->size * 2;
+        void **tmp = realloc(s->items, size * sizeof(void *));
+        if (tmp == NULL)
+        {
+            return false;
+        }
+        s->items = tmp;
+        s->size = size;
     }
 
-    tmp->next = s->top;
-    tmp->data = data;
-    s->top = tmp;
-    s->count += 1;
+    s->items[s->count++] = data;
     return true;
 }
 
 void stack_pop(stack *s, void (*free_data)(void *))
 {
-    if (s->top == NULL)
+    if (s->count == 0)
     {
         return;
     }
 
-    struct stack_el *tmp = s->top;
-    s->top = tmp->next;
-    s->count -= 1;
-    free_data(tmp->data);
-    free(tmp);
+    free_data(s->items[--s->count]);
 }
 
-void stack_dispose(stack *s, void (*free_data)(void *))
+void *stack_top(stack *s)
+{
+    return s->count == 0 ? NULL : s->items[s->count - 1];
+}
+
+void stack_clear(stack *s, void (*free_data)(void *))
 {
-    while (s->top != NULL)
+    while (s->count != 0)
     {
         stack_pop(s, free_data);
     }
 }
 
+void stack_dispose(stack *s, void (*free_data)(void *))
+{
+    stack_clear(s, free_data);
+    free(s->items);
+    stack_init(s);
+}
+
 void stack_nofree(void *data)
 {
     (void)data;
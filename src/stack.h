@@ -14,40 +14,40 @@
 #include <stdlib.h>
 #include <stdbool.h>
 
-/**
- * @struct Stack element
- */
-struct stack_el
-{
-    struct stack_el *next;
-    void *data;
-};
+#define STACK_INIT_SIZE 16 // Capacity allocated by the first push
 
 /**
  * @struct Stack
  * 
- * Generic stack implementation. Pointer to any data is stored in stack element's "data"
+ * Generic stack implementation. Pointers to any data are stored in the "items" array
  * 
- * The stack is implemented as a singly linked list
+ * The stack is implemented as a growable array, items[count - 1] is the top
  */
 typedef struct
 {
-    struct stack_el *top;
+    void **items;
     unsigned int count;
+    unsigned int size; // Capacity of items
 } stack;
 
 /**
- * @brief Initializes stack to NULL
+ * @brief Initializes an empty stack, nothing is allocated until the first push
  * @param s Stack pointer
  */
 void stack_init(stack *s);
 
 /**
- * @brief Disposes all elements on the stack
+ * @brief Disposes all elements on the stack and frees the array
  * @param s Stack pointer
  */
 void stack_dispose(stack *s, void (*free_data)(void *));
 
+/**
+ * @brief Removes all elements from the stack, the array is kept for reuse
+ * @param s Stack pointer
+ */
+void stack_clear(stack *s, void (*free_data)(void *));
+
 /**
  * @brief Pushes data on top of the stack
  * @param data Pointer to some data
@@ -60,6 +60,12 @@ bool stack_push(stack *s, void *data);
  */
 void stack_pop(stack *s, void (*free_data)(void *));
 
+/**
+ * @brief Returns data on top of the stack
+ * @return Pointer to the data, NULL if the stack is empty
+ */
+void *stack_top(stack *s);
+
 /**
  * @brief The function does not do anything useful
  * 
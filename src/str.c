@@ -11,8 +11,43 @@
  * @author Petr Kabelka <xkabel09 at stud.fit.vutbr.cz>
  */
 
+#include <limits.h>
 #include "str.h"
 
+/**
+ * @brief Makes room for at least size bytes, doubling the allocation
+ * @param s Pointer to the string structure
+ * @param size Required memory size including the terminating null byte
+ * @return True upon success
+ */
+static bool str_reserve(string *s, unsigned int size)
+{
+    if (size <= s->mem_size)
+    {
+        return true;
+    }
+
+    unsigned int mem_size = s->mem_size < STR_ALLOC_CONST ? STR_ALLOC_CONST : s->mem_size;
+    while (mem_size < size)
+    {
+        if (mem_size > UINT_MAX / 2)
+        {
+            mem_size = size; // doubling would wrap around
+            break;
+        }
+        mem_size *= 2;
+    }
+
+    char *str = (char*) realloc(s->str, mem_size * sizeof(char));
+    if (str == NULL)
+    {
+        return false;
+    }
+    s->str = str;
+    s->mem_size = mem_size;
+    return true;
+}
+
 bool str_init(string *s)
 {
     if ((s->str = (char*) malloc(sizeof(char) * STR_ALLOC_CONST)) == NULL)
@@ -41,13 +76,9 @@ void str_clear(string *s)
 
 bool str_add(string *s, char c)
 {
-    if ((s->len + 1) >= s->mem_size)
+    if (s->len > UINT_MAX - 2 || !str_reserve(s, s->len + 2))
     {
-        if ((s->str = (char*) realloc(s->str, (s->len + STR_ALLOC_CONST) * sizeof(char))) == NULL)
-        {
-            return false;
-        }
-        s->mem_size = s->len + STR_ALLOC_CONST;
+        return false;
     }
 
     s->str[s->len++] = c;
@@ -55,24 +86,24 @@ bool str_add(string *s, char c)
     return true;
 }
 
-bool str_add_const(string *s, const char *cstr)
+bool str_add_len(string *s, const char *cstr, unsigned int len)
 {
-    unsigned int cstr_len = (unsigned int)strlen(cstr);
-    if ((s->len + cstr_len + 1) >= s->mem_size)
+    if (len > UINT_MAX - 1 - s->len || !str_reserve(s, s->len + len + 1))
     {
-        if ((s->str = (char*) realloc(s->str, (s->len + cstr_len + 1) * sizeof(char))) == NULL)
-        {
-            return false;
-        }
-        s->mem_size = s->len + cstr_len + 1;
+        return false;
     }
 
-    s->len += cstr_len;
-    strcat(s->str, cstr);
+    memcpy(s->str + s->len, cstr, len);
+    s->len += len;
     s->str[s->len] = '\0';
     return true;
 }
 
+bool str_add_const(string *s, const char *cstr)
+{
+    return str_add_len(s, cstr, (unsigned int)strlen(cstr));
+}
+
 bool str_add_var(string *s, ...)
 {
     va_list ap;
@@ -80,19 +111,11 @@ bool str_add_var(string *s, ...)
     char *cstr;
     while ((cstr = va_arg(ap, char *)) != NULL)
     {
-        unsigned int cstr_len = (unsigned int)strlen(cstr);
-        if ((s->len + cstr_len + 1) >= s->mem_size)
+        if (!str_add_len(s, cstr, (unsigned int)strlen(cstr)))
         {
-            if ((s->str = (char*) realloc(s->str, (s->len + cstr_len + 1) * sizeof(char))) == NULL)
-            {
-                return false;
-            }
-            s->mem_size = s->len + cstr_len + 1;
+            va_end(ap);
+            return false;
         }
-
-        s->len += cstr_len;
-        strcat(s->str, cstr);
-        s->str[s->len] = '\0';
     }
     va_end(ap);
     return true;
@@ -100,33 +123,17 @@ bool str_add_var(string *s, ...)
 
 bool str_add_str(string *s1, string *s2)
 {
-    if ((s1->len + s2->len + 1) >= s1->mem_size)
-    {
-        if ((s1->str = (char*) realloc(s1->str, (s1->len + s2->len + 1) * sizeof(char))) == NULL)
-        {
-            return false;
-        }
-        s1->mem_size = (s1->len + s2->len + 1) * sizeof(char);
-    }
-
-    s1->len += s2->len;
-    strcat(s1->str, s2->str);
-    s1->str[s1->len] = '\0';
-    return true;
+    return str_add_len(s1, s2->str, s2->len);
 }
 
 bool str_copy(string *src, string *dst)
 {
-    if ((src->len + 1) >= dst->mem_size)
+    if (!str_reserve(dst, src->len + 1))
     {
-        if ((dst->str = (char*) realloc(dst->str, (src->len + 1) * sizeof(char))) == NULL)
-        {
-            return false;
-        }
-        dst->mem_size = src->len + 1;
+        return false;
     }
 
-    strcpy(dst->str, src->str);
+    memcpy(dst->str, src->str, src->len + 1);
     dst->len = src->len;
     return true;
 }
@@ -141,6 +148,17 @@ int str_cmp_const(string *s1, const char *s2)
     return strcmp(s1->str, s2);
 }
 
+unsigned int str_hash(const char *cstr, unsigned int len)
+{
+    unsigned int hash = 2166136261u;
+    for (unsigned int i = 0; i < len; i++)
+    {
+        hash ^= (unsigned char)cstr[i];
+        hash *= 16777619u;
+    }
+    return hash != 0 ? hash : 1;
+}
+
 void str_swap(string *s1, string *s2)
 {
     string tmp = *s1;
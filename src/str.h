@@ -19,7 +19,7 @@
 #include <string.h>
 #include <stdarg.h>
 
-#define STR_ALLOC_CONST 8 // Constant of 8 bytes to prevent reallocating with each character
+#define STR_ALLOC_CONST 8 // Initial allocation, doubled whenever the string runs out of memory
 
 /**
  * @struct Dynamic string
@@ -56,6 +56,15 @@ void str_clear(string *s);
  */
 bool str_add(string *s, char c);
 
+/**
+ * @brief Appends len bytes of cstr to the dynamic string
+ * @param s Pointer to the string structure
+ * @param cstr Appended characters, need not be null terminated
+ * @param len Number of appended characters
+ * @return True upon successful append
+ */
+bool str_add_len(string *s, const char *cstr, unsigned int len);
+
 /**
  * @brief Appends a string literal to the dynamic string
  * @param s Pointer to the string structure
@@ -104,6 +113,14 @@ int str_cmp(string *s1, string *s2);
  */
 int str_cmp_const(string *s1, const char *s2);
 
+/**
+ * @brief FNV-1a hash of len characters of cstr
+ * @param cstr Hashed characters, need not be null terminated
+ * @param len Number of hashed characters
+ * @return Hash of the characters, never 0 so it can mark an empty hash table slot
+ */
+unsigned int str_hash(const char *cstr, unsigned int len);
+
 /**
  * @brief Swaps the two strings
  * @param s1 Pointer to the first string
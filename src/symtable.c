@@ -2,7 +2,7 @@
  * Project name: Imperative language IFJ20 compiler implementation
  * Název projektu: Implementace překladače imperativního jazyka IFJ20
  * 
- * @brief Binary tree symbol table interface
+ * @brief Hash table symbol table implementation
  *
  * @author Kryštof Glos <xglosk01 at stud.fit.vutbr.cz>
  * @author Petr Kabelka <xkabel09 at stud.fit.vutbr.cz>
@@ -12,243 +12,230 @@
 #include "error.h"
 #include "stack.h"
 
-void symtable_init(stnode_ptr *root)
+/**
+ * @brief Copies the node src to dst and keeps an inline key pointing into dst
+ */
+static void move_node(struct stnode *dst, struct stnode *src)
 {
-    *root = NULL;
+    bool short_key = src->key == src->short_key;
+    *dst = *src;
+    if (short_key)
+    {
+        dst->key = dst->short_key;
+    }
 }
 
-stnode_ptr symtable_insert(stnode_ptr *root, const char *key, bool *error)
+static symtable_ptr table_alloc(unsigned int size)
 {
-    *error = false;
-
-    if (*root == NULL)
+    symtable_ptr table = malloc(sizeof(struct symtable) + size * sizeof(struct stnode));
+    if (table == NULL)
     {
-        stnode_ptr new = malloc(sizeof(struct stnode));
-        if (new == NULL)
-        {
-            *error = true;
-            return NULL;
-        }
-        new->lnode = NULL;
-        new->rnode = NULL;
-        new->key = (char *)malloc(strlen(key) + sizeof(char));
-        if (new->key == NULL)
-        {
-            *error = true;
-            return NULL;
-        }
-        strcpy(new->key, key);
-
-        *root = new;
-        return new;
+        return NULL;
     }
+    table->size = size;
+    table->count = 0;
+    for (unsigned int i = 0; i < size; i++)
+    {
+        table->nodes[i].hash = 0;
+    }
+    return table;
+}
 
-    stnode_ptr tmp = *root;
-    while (tmp != NULL)
+/**
+ * @brief Puts the node into the table starting at slot idx, richer nodes are pushed further
+ * @param table table with at least one empty slot
+ * @param node node to be placed, its dist must be valid for slot idx
+ * @param idx first slot to try
+ * @return slot where the node was placed
+ */
+static stnode_ptr place_node(symtable_ptr table, struct stnode *node, unsigned int idx)
+{
+    unsigned int mask = table->size - 1;
+    stnode_ptr placed = NULL;
+    struct stnode carry, tmp;
+    move_node(&carry, node);
+
+    while (table->nodes[idx].hash != 0)
     {
-        int comp = strcmp(tmp->key, key);
-        if (comp > 0) // New node will be inserted on the left side of current
-        {
-            if (tmp->lnode != NULL)
-            {
-                tmp = tmp->lnode; // No free space, we go further
-            }
-            else
-            {
-                stnode_ptr new = malloc(sizeof(struct stnode));
-                if (new == NULL)
-                {
-                    *error = true;
-                    return NULL;
-                }
-
-                new->lnode = NULL;
-                new->rnode = NULL;
-                new->key = (char *)malloc(strlen(key) + sizeof(char));
-                if (new->key == NULL)
-                {
-                    *error = true;
-                    return NULL;
-                }
-                strcpy(new->key, key);
-
-                tmp->lnode = new; // new node is on the left
-                return new;
-            }
-        }
-        else if (comp < 0) // new node will be inserted on the left side of current
+        stnode_ptr slot = &table->nodes[idx];
+        if (slot->dist < carry.dist)
         {
-            if (tmp->rnode != NULL)
+            // the poorer node takes the slot and the richer one moves on
+            move_node(&tmp, slot);
+            move_node(slot, &carry);
+            move_node(&carry, &tmp);
+            if (placed == NULL)
             {
-                tmp = tmp->rnode; // No free space, we go futher
-            }
-            else
-            {
-                stnode_ptr new = malloc(sizeof(struct stnode));
-                if (new == NULL)
-                {
-                    *error = true;
-                    return NULL;
-                }
-
-                new->lnode = NULL;
-                new->rnode = NULL;
-                new->key = (char *)malloc(strlen(key) + sizeof(char));
-                if (new->key == NULL)
-                {
-                    *error = true;
-                    return NULL;
-                }
-                strcpy(new->key, key);
-
-                tmp->rnode = new; // new node will be inserted on the right side of current
-                return new;
+                placed = slot;
             }
         }
-        else
-        {
-            return NULL;
-        }
+        idx = (idx + 1) & mask;
+        carry.dist++;
     }
-    return NULL; // prevents warning: control reaches end of non-void function
+
+    move_node(&table->nodes[idx], &carry);
+    table->count++;
+    return placed != NULL ? placed : &table->nodes[idx];
 }
 
-stnode_ptr symtable_search(stnode_ptr root, const char *key)
+static bool table_grow(symtable_ptr *table)
 {
-    if (root == NULL)
+    symtable_ptr old = *table;
+    symtable_ptr new = table_alloc(old->size * 2);
+    if (new == NULL)
     {
-        return NULL;
+        return false;
     }
 
-    stnode_ptr tmp = root;
-    while (tmp != NULL)
+    for (unsigned int i = 0; i < old->size; i++)
     {
-        int comp = strcmp(key, tmp->key);
-        if (comp == 0)
-        {
-            return tmp;
-        }
-        else if (comp < 0)
+        if (old->nodes[i].hash != 0)
         {
-            tmp = tmp->lnode;
-        }
-        else if (comp > 0)
-        {
-            tmp = tmp->rnode;
+            old->nodes[i].dist = 0;
+            place_node(new, &old->nodes[i], old->nodes[i].hash & (new->size - 1));
         }
     }
-    return NULL;
+    free(old);
+    *table = new;
+    return true;
 }
 
-/**
- * @brief Goes trhough left brand of subtree untill gets on the most left node
- * @param ptr node to walk through
-*/
-static void leftmost_inorder(stnode_ptr ptr, stack *st)
+void symtable_init(symtable_ptr *table)
 {
-    while (ptr != NULL)
-    {
-        stack_push(st, ptr);
-        ptr = ptr->lnode;
-    }
+    *table = NULL;
 }
 
-void symtable_dispose(stnode_ptr *root, void (*free_data)(void *))
+stnode_ptr symtable_insert(symtable_ptr *table, const char *key, bool *error)
 {
-    if (*root == NULL)
+    return symtable_insert_hash(table, key, str_hash(key, strlen(key)), error);
+}
+
+stnode_ptr symtable_insert_hash(symtable_ptr *table, const char *key, unsigned int hash, bool *error)
+{
+    *error = false;
+
+    if (*table == NULL)
     {
-        return;
+        if ((*table = table_alloc(SYMTABLE_INIT_SIZE)) == NULL)
+        {
+            *error = true;
+            return NULL;
+        }
+    }
+    else if (symtable_search_hash(*table, key, hash) != NULL)
+    {
+        return NULL;
     }
 
-    stack st;
-    stack_init(&st);
+    // keep the load factor under 3/4
+    if (((*table)->count + 1) * 4 > (*table)->size * 3 && !table_grow(table))
+    {
+        *error = true;
+        return NULL;
+    }
 
-    stnode_ptr ptr = *root;
-    leftmost_inorder(ptr, &st);
-    while (st.top != NULL)
+    struct stnode new;
+    size_t len = strlen(key);
+    if (len < SYMTABLE_INLINE_KEY)
     {
-        ptr = st.top->data;
-        stack_pop(&st, stack_nofree);
-        leftmost_inorder(ptr->rnode, &st);
-        free_data(ptr->data);
-        free(ptr->key);
-        free(ptr);
+        new.key = new.short_key;
+    }
+    else if ((new.key = (char *)malloc(len + sizeof(char))) == NULL)
+    {
+        *error = true;
+        return NULL;
     }
-    *root = NULL;
+    memcpy(new.key, key, len + 1);
+    new.data = NULL;
+    new.hash = hash;
+    new.dist = 0;
+
+    return place_node(*table, &new, new.hash & ((*table)->size - 1));
+}
+
+stnode_ptr symtable_search(symtable_ptr table, const char *key)
+{
+    return symtable_search_hash(table, key, str_hash(key, strlen(key)));
 }
 
-static void replace_by_rightmost (stnode_ptr ptr_replaced, stnode_ptr *root, void (*free_data)(void *))
+stnode_ptr symtable_search_hash(symtable_ptr table, const char *key, unsigned int hash)
 {
-    if (*root != NULL)
+    if (table == NULL)
+    {
+        return NULL;
+    }
+
+    unsigned int mask = table->size - 1;
+    unsigned int idx = hash & mask;
+    for (unsigned int dist = 0; table->nodes[idx].hash != 0; dist++)
     {
-        if ((*root)->rnode != NULL)
+        stnode_ptr node = &table->nodes[idx];
+        if (node->dist < dist)
         {
-            replace_by_rightmost(ptr_replaced, &(*root)->rnode, free_data);
+            return NULL; // the key would have taken this slot
         }
-        else
+        if (node->hash == hash && strcmp(node->key, key) == 0)
         {
-            free(ptr_replaced->key);
-            free_data(ptr_replaced->data);
-            ptr_replaced->data = (*root)->data;
-            ptr_replaced->key = (*root)->key;
-            if ((*root)->lnode != NULL)
-            {
-                stnode_ptr old_root = *root;
-                *root = (*root)->lnode;
-                free(old_root);
-            }
-            else
-            {
-                free(*root);
-                *root = NULL;
-            }
+            return node;
         }
+        idx = (idx + 1) & mask;
     }
+    return NULL;
 }
 
-void symtable_delete_node (stnode_ptr *root, const char *key, void (*free_data)(void *))
+void symtable_dispose(symtable_ptr *table, void (*free_data)(void *))
 {
-    if (*root == NULL)
+    if (*table == NULL)
     {
         return;
     }
-    int comp = strcmp(key, (*root)->key);
-    if (comp < 0)
+
+    for (unsigned int i = 0; i < (*table)->size; i++)
     {
-        symtable_delete_node(&(*root)->lnode, key, free_data);
+        stnode_ptr node = &(*table)->nodes[i];
+        if (node->hash != 0)
+        {
+            free_data(node->data);
+            if (node->key != node->short_key)
+            {
+                free(node->key);
+            }
+        }
     }
-    else if (comp > 0)
+    free(*table);
+    *table = NULL;
+}
+
+void symtable_delete_node(symtable_ptr *table, const char *key, void (*free_data)(void *))
+{
+    symtable_delete_node_hash(table, key, str_hash(key, strlen(key)), free_data);
+}
+
+void symtable_delete_node_hash(symtable_ptr *table, const char *key, unsigned int hash, void (*free_data)(void *))
+{
+    stnode_ptr node = symtable_search_hash(*table, key, hash);
+    if (node == NULL)
     {
-        symtable_delete_node(&(*root)->rnode, key, free_data);
+        return;
     }
-    else
+
+    free_data(node->data);
+    if (node->key != node->short_key)
     {
-        if ((*root)->lnode == NULL && (*root)->rnode == NULL)
-        {
-            free_data((*root)->data);
-            free((*root)->key);
-            free(*root);
-            *root = NULL;
-        }
-        else if ((*root)->lnode != NULL && (*root)->rnode != NULL)
-        {
-            replace_by_rightmost(*root, &(*root)->lnode, free_data);
-        }
-        else if ((*root)->lnode == NULL)
-        {
-            stnode_ptr old_root = *root;
-            *root = (*root)->rnode;
-            free_data(old_root->data);
-            free(old_root->key);
-            free(old_root);
-        }
-        else if ((*root)->rnode == NULL)
-        {
-            stnode_ptr old_root = *root;
-            *root = (*root)->lnode;
-            free_data(old_root->data);
-            free(old_root->key);
-            free(old_root);
-        }
+        free(node->key);
+    }
+
+    // shift the following nodes back so no tombstone is needed
+    unsigned int mask = (*table)->size - 1;
+    unsigned int idx = node - (*table)->nodes;
+    unsigned int next = (idx + 1) & mask;
+    while ((*table)->nodes[next].hash != 0 && (*table)->nodes[next].dist != 0)
+    {
+        move_node(&(*table)->nodes[idx], &(*table)->nodes[next]);
+        (*table)->nodes[idx].dist--;
+        idx = next;
+        next = (next + 1) & mask;
     }
+    (*table)->nodes[idx].hash = 0;
+    (*table)->count--;
 }
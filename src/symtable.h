@@ -2,7 +2,10 @@
  * Project name: Imperative language IFJ20 compiler implementation
  * Název projektu: Implementace překladače imperativního jazyka IFJ20
  * 
- * @brief Binary tree symbol table implementation
+ * @brief Hash table symbol table interface
+ *
+ * Open addressing with Robin Hood linear probing. Nodes are stored inline
+ * in one array and short keys are stored inside the node itself.
  *
  * @author Kryštof Glos <xglosk01 at stud.fit.vutbr.cz>
  * @author Petr Kabelka <xkabel09 at stud.fit.vutbr.cz>
@@ -17,6 +20,9 @@
 #include "str.h"
 #include "stack.h"
 
+#define SYMTABLE_INIT_SIZE 8 // Initial number of slots, always a power of two
+#define SYMTABLE_INLINE_KEY 16 // Keys shorter than this are stored in the node
+
 typedef enum
 {
     NONE,
@@ -36,43 +42,71 @@ typedef struct stdata
 
 /**
  * @struct Symbol table node
+ *
+ * Nodes are moved inside the table, so a node pointer is only valid
+ * until the next insertion or deletion in the same table.
  */
 typedef struct stnode {
-    char *key; // node key
+    char *key; // node key, points either to short_key or to a heap copy
     void *data;
-    struct stnode *lnode; // left subtree
-    struct stnode *rnode; // right subtree
+    unsigned int hash; // 0 marks an empty slot
+    unsigned int dist; // distance from the slot the hash points to
+    char short_key[SYMTABLE_INLINE_KEY];
 } *stnode_ptr;
 
 /**
- * @brief Initializes new symtable
- * @param root tree to be initialized
+ * @struct Symbol table
+ */
+typedef struct symtable {
+    unsigned int size; // number of slots
+    unsigned int count; // number of used slots
+    struct stnode nodes[];
+} *symtable_ptr;
+
+/**
+ * @brief Initializes new symtable, the table memory is allocated on the first insertion
+ * @param table table to be initialized
  */
-void symtable_init(stnode_ptr *root);
+void symtable_init(symtable_ptr *table);
 
 /**
- * @brief searches const char in given tree, returns matching node
+ * @brief searches const char in given table, returns matching node
  */
-stnode_ptr symtable_search(stnode_ptr root, const char *key);
+stnode_ptr symtable_search(symtable_ptr table, const char *key);
 
 /**
- * @brief Inserts in symtable new node with value of Content
- * @param c const char to be inserted as string
+ * @brief symtable_search with the str_hash of the key already known, e.g. from an atom
  */
-stnode_ptr symtable_insert (stnode_ptr *root, const char *key, bool *error);
+stnode_ptr symtable_search_hash(symtable_ptr table, const char *key, unsigned int hash);
 
 /**
- * @brief Disposes all nodes in tree and frees memory
- * @param root pointer to the tree to be disposed
+ * @brief Inserts in symtable new node with the given key
+ * @return the new node or NULL if the key already exists or there was an error
+ */
+stnode_ptr symtable_insert(symtable_ptr *table, const char *key, bool *error);
+
+/**
+ * @brief symtable_insert with the str_hash of the key already known
+ */
+stnode_ptr symtable_insert_hash(symtable_ptr *table, const char *key, unsigned int hash, bool *error);
+
+/**
+ * @brief Disposes all nodes in table and frees memory
+ * @param table pointer to the table to be disposed
  * @param free_data pointer to a function which frees the node data
  */
-void symtable_dispose(stnode_ptr *root, void (*free_data)(void *));
+void symtable_dispose(symtable_ptr *table, void (*free_data)(void *));
 
 /**
  * @brief Deletes a node in symtable
- * @param root pointer to a tree root pointer
+ * @param table pointer to the table
  * @param key key of the node to delete
  */
-void symtable_delete_node (stnode_ptr *root, const char *key, void (*free_data)(void *));
+void symtable_delete_node(symtable_ptr *table, const char *key, void (*free_data)(void *));
+
+/**
+ * @brief symtable_delete_node with the str_hash of the key already known
+ */
+void symtable_delete_node_hash(symtable_ptr *table, const char *key, unsigned int hash, void (*free_data)(void *));
 
 #endif
@@ -0,0 +1,256 @@
+/**
+ * Project name: Imperative language IFJ20 compiler implementation
+ * Název projektu: Implementace překladače imperativního jazyka IFJ20
+ *
+ * @brief Tail call optimizer implementation
+ *
+ * @author Daniel Moudrý <xmoudr01 at stud.fit.vutbr.cz>
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "tailcall.h"
+
+#define MAX_ARGS 16
+#define MAX_MOVES 32
+#define ACCUMULATED -2 // the result combined with the accumulated operand
+
+static const ir_operand acc_var = { IR_VAR, "LF@%acc" };
+static const ir_operand retval0 = { IR_VAR, "LF@%retval0" };
+
+typedef enum {
+    TAIL_NONE, // the results are not returned as they are
+    TAIL_PLAIN, // return f(..)
+    TAIL_ACC // return x + f(..) or x * f(..)
+} tail_kind;
+
+typedef struct {
+    const char *var[MAX_MOVES];
+    int result[MAX_MOVES]; // result of the call the variable holds, -1 for another value
+    unsigned int count;
+} values_t;
+
+static int held(values_t *v, const ir_operand *o);
+static bool written(values_t *v, const ir_operand *o);
+static bool set(values_t *v, const ir_operand *o, int result);
+static unsigned int find_label(ir_list *code, const ir_operand *label);
+static tail_kind follow(ir_list *code, unsigned int i, unsigned int nret, ir_instr *acc);
+static bool emit(ir_list *out, ir_opcode op, const ir_operand *a, const ir_operand *b, const ir_operand *c);
+
+bool tail_calls(ir_func *f) {
+    ir_list *code = &f->code;
+    unsigned int count = code->count;
+    if (count < 4 || code->items[1].op != IR_PUSHFRAME || code->items[count - 2].op != IR_POPFRAME
+        || code->items[count - 1].op != IR_RETURN)
+        return true; // main does not return
+
+    // number and type of the results, the first move into %retval0 is its default value
+    unsigned int nret = 0;
+    int int_result = -1;
+    for (unsigned int i = 0; i < count; i++) {
+        ir_instr *instr = &code->items[i];
+        if (instr->op == IR_DEFVAR && strncmp(instr->args[0].text, "LF@%retval", 10) == 0)
+            nret++;
+        if (instr->op == IR_MOVE && int_result < 0 && ir_operand_equal(&instr->args[0], &retval0))
+            int_result = strncmp(instr->args[1].text, "int@", 4) == 0;
+    }
+
+    // all accumulating calls have to use the same operator
+    ir_opcode acc_op = IR_OPCODE_COUNT;
+    bool loop = false, conflict = false;
+    ir_operand args[MAX_ARGS];
+    unsigned int nargs;
+    ir_instr acc;
+    for (unsigned int i = 0; i < count; i++) {
+        int p = ir_call(code, i, args, MAX_ARGS, &nargs);
+        if (p < 0 || strcmp(code->items[p].args[0].text + 1, f->name) != 0)
+            continue;
+        tail_kind kind = follow(code, p + 1, nret, &acc);
+        loop |= kind == TAIL_PLAIN;
+        if (kind == TAIL_ACC && int_result == 1) {
+            conflict |= acc_op != IR_OPCODE_COUNT && acc_op != acc.op;
+            acc_op = acc.op;
+        }
+    }
+    if (conflict)
+        acc_op = IR_OPCODE_COUNT;
+    loop |= acc_op != IR_OPCODE_COUNT;
+
+    ir_operand entry = { IR_LABEL_REF, NULL };
+    if (loop && (entry = ir_operand_fmt(&f->text, IR_LABEL_REF, "$%s$tail", f->name)).text == NULL)
+        return false;
+    ir_list out;
+    ir_init(&out);
+    bool ok = true;
+    for (unsigned int i = 0; ok && i < count; i++) {
+        ir_instr *instr = &code->items[i];
+        if (loop && instr->op == IR_DEFVAR && strncmp(instr->args[0].text, "LF@", 3) == 0)
+            continue; // declared before the entry of the loop
+        if (i == count - 2 && acc_op != IR_OPCODE_COUNT)
+            ok = emit(&out, acc_op, &retval0, &retval0, &acc_var);
+
+        int p = ir_call(code, i, args, MAX_ARGS, &nargs);
+        tail_kind kind = p >= 0 ? follow(code, p + 1, nret, &acc) : TAIL_NONE;
+        bool self = p >= 0 && strcmp(code->items[p].args[0].text + 1, f->name) == 0;
+        if (self && (kind == TAIL_PLAIN || (kind == TAIL_ACC && acc.op == acc_op))) {
+            // the arguments become the parameters of the next iteration
+            if (kind == TAIL_ACC)
+                ok = emit(&out, acc_op, &acc_var, &acc_var, &acc.args[1]);
+            for (unsigned int k = 0; ok && k < nargs; k++) {
+                ir_operand param = ir_operand_fmt(&f->text, IR_VAR, "LF@%%%u", k);
+                ok = param.text != NULL && emit(&out, IR_MOVE, &param, &args[k], NULL);
+            }
+            ok = ok && emit(&out, IR_JUMP, &entry, NULL, NULL);
+        }
+        else if (!self && kind == TAIL_PLAIN && acc_op == IR_OPCODE_COUNT) {
+            // the arguments are kept on the data stack while the frame is replaced
+            for (unsigned int k = 0; ok && k < nargs; k++)
+                ok = emit(&out, IR_PUSHS, &args[k], NULL, NULL);
+            ok = ok && emit(&out, IR_POPFRAME, NULL, NULL, NULL) && emit(&out, IR_CREATEFRAME, NULL, NULL, NULL);
+            for (unsigned int k = nargs; ok && k-- > 0;) {
+                ir_operand arg = ir_operand_fmt(&f->text, IR_VAR, "TF@%%%u", k);
+                ok = arg.text != NULL && emit(&out, IR_DEFVAR, &arg, NULL, NULL) && emit(&out, IR_POPS, &arg, NULL, NULL);
+            }
+            ok = ok && emit(&out, IR_JUMP, &code->items[p].args[0], NULL, NULL);
+        }
+        else {
+            ok = ok && ir_add(&out, instr);
+            if (ok && i == 1 && loop) {
+                // PUSHFRAME, the declarations, the accumulator and the entry of the loop
+                for (unsigned int j = 0; ok && j < count; j++) {
+                    ir_instr *decl = &code->items[j];
+                    if (decl->op == IR_DEFVAR && strncmp(decl->args[0].text, "LF@", 3) == 0)
+                        ok = ir_add(&out, decl);
+                }
+                if (acc_op != IR_OPCODE_COUNT) {
+                    ir_operand identity = { IR_CONST, acc_op == IR_MUL ? "int@1" : "int@0" };
+                    ok = ok && emit(&out, IR_DEFVAR, &acc_var, NULL, NULL) && emit(&out, IR_MOVE, &acc_var, &identity, NULL);
+                }
+                ok = ok && emit(&out, IR_LABEL, &entry, NULL, NULL);
+            }
+            continue;
+        }
+
+        // the moves of the results are never reached now
+        i = p;
+        while (i + 1 < count && code->items[i + 1].op != IR_LABEL)
+            i++;
+    }
+
+    if (ok)
+        ir_swap(code, &out);
+    ir_free(&out);
+    return ok;
+}
+
+/**
+ * Returns the index of the call result the operand holds, -1 for another value.
+ */
+static int held(values_t *v, const ir_operand *o) {
+    if (strncmp(o->text, "TF@%retval", 10) == 0)
+        return strtol(o->text + 10, NULL, 10);
+    for (unsigned int i = v->count; i-- > 0;) {
+        if (strcmp(v->var[i], o->text) == 0)
+            return v->result[i];
+    }
+    return -1;
+}
+
+/**
+ * Checks whether the variable was written since the call.
+ */
+static bool written(values_t *v, const ir_operand *o) {
+    for (unsigned int i = 0; i < v->count; i++) {
+        if (strcmp(v->var[i], o->text) == 0)
+            return true;
+    }
+    return false;
+}
+
+static bool set(values_t *v, const ir_operand *o, int result) {
+    if (v->count == MAX_MOVES)
+        return false;
+    v->var[v->count] = o->text;
+    v->result[v->count++] = result;
+    return true;
+}
+
+static unsigned int find_label(ir_list *code, const ir_operand *label) {
+    for (unsigned int i = 0; i < code->count; i++) {
+        if (code->items[i].op == IR_LABEL && ir_operand_equal(&code->items[i].args[0], label))
+            return i;
+    }
+    return code->count;
+}
+
+/**
+ * Follows the code after a call at index i to the return of the function. Only moves,
+ * labels, jumps and one accumulating operation may be on the way and every result
+ * of the function has to be the result of the call of the same index.
+ */
+static tail_kind follow(ir_list *code, unsigned int i, unsigned int nret, ir_instr *acc) {
+    values_t v;
+    v.count = 0;
+    bool accumulated = false;
+    for (unsigned int steps = 0; i < code->count && steps < code->count; steps++) {
+        ir_instr *instr = &code->items[i];
+        switch (instr->op) {
+            case IR_LABEL:
+                i++;
+                break;
+            case IR_JUMP:
+                i = find_label(code, &instr->args[0]);
+                break;
+            case IR_MOVE:
+                if (!set(&v, &instr->args[0], held(&v, &instr->args[1])))
+                    return TAIL_NONE;
+                i++;
+                break;
+            case IR_ADD:
+            case IR_MUL: {
+                // %retval0 = x op result, x keeps the value it had at the call
+                bool first = held(&v, &instr->args[1]) == 0;
+                const ir_operand *other = first ? &instr->args[2] : &instr->args[1];
+                if (accumulated || nret != 1 || !ir_operand_equal(&instr->args[0], &retval0)
+                    || (!first && held(&v, &instr->args[2]) != 0) || held(&v, other) != -1 || written(&v, other))
+                    return TAIL_NONE;
+                accumulated = true;
+                acc->op = instr->op;
+                acc->args[1] = *other;
+                if (!set(&v, &instr->args[0], ACCUMULATED))
+                    return TAIL_NONE;
+                i++;
+                break;
+            }
+            case IR_POPFRAME:
+                if (i + 1 >= code->count || code->items[i + 1].op != IR_RETURN)
+                    return TAIL_NONE;
+                if (accumulated)
+                    return held(&v, &retval0) == ACCUMULATED ? TAIL_ACC : TAIL_NONE;
+                for (unsigned int r = 0; r < nret; r++) {
+                    char name[32];
+                    sprintf(name, "LF@%%retval%u", r);
+                    ir_operand result = { IR_VAR, name };
+                    if (held(&v, &result) != (int)r)
+                        return TAIL_NONE;
+                }
+                return TAIL_PLAIN;
+            default:
+                return TAIL_NONE;
+        }
+    }
+    return TAIL_NONE;
+}
+
+static bool emit(ir_list *out, ir_opcode op, const ir_operand *a, const ir_operand *b, const ir_operand *c) {
+    ir_instr instr;
+    instr.op = op;
+    instr.nargs = (a != NULL) + (b != NULL) + (c != NULL);
+    if (a != NULL)
+        instr.args[0] = *a;
+    if (b != NULL)
+        instr.args[1] = *b;
+    if (c != NULL)
+        instr.args[2] = *c;
+    return ir_add(out, &instr);
+}
@@ -0,0 +1,29 @@
+/**
+ * Project name: Imperative language IFJ20 compiler implementation
+ * Název projektu: Implementace překladače imperativního jazyka IFJ20
+ *
+ * @brief Tail call optimizer interface
+ *
+ * @author Daniel Moudrý <xmoudr01 at stud.fit.vutbr.cz>
+ */
+
+#ifndef _TAILCALL_H
+#define _TAILCALL_H
+
+#include "inliner.h"
+
+/**
+ * @brief Replaces the calls whose results are returned right away by jumps
+ *
+ * A call of the function itself assigns the arguments to its parameters and jumps
+ * behind the declarations at its entry. It may also be the operand of a single int
+ * addition or multiplication, e.g. return n * f(n - 1), the other operand is then
+ * accumulated in LF@%acc and applied to the result at the return. A call of another
+ * function pops the frame of the caller first and jumps to the callee, which returns
+ * straight to the caller's caller. Neither grows the frame or the call stack.
+ *
+ * @return false if there was an error
+ */
+bool tail_calls(ir_func *f);
+
+#endif
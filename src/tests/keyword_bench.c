@@ -0,0 +1,129 @@
+/**
+ * Project name: Imperative language IFJ20 compiler implementation
+ * Název projektu: Implementace překladače imperativního jazyka IFJ20
+ *
+ * @brief Keyword recognition micro-benchmark
+ *
+ * Compares keyword_lookup with the chain of strcmp calls the scanner used
+ * before on an identifier-heavy word list.
+ *
+ * @author Petr Kabelka <xkabel09 at stud.fit.vutbr.cz>
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include "../scanner.h"
+
+#define WORDS 4096
+#define ROUNDS 2000
+
+static const char *keywords[] = {
+    "int", "float64", "string", "nil", "_", "if", "else", "for", "package",
+    "func", "return", "print", "inputs", "inputi", "inputf", "int2float",
+    "float2int", "len", "substr", "ord", "chr",
+};
+
+static const char *identifiers[] = {
+    "i", "j", "n", "x", "idx", "tmp", "str", "err", "res", "sum", "acc",
+    "index", "value", "count", "result", "input", "inputx", "integer",
+    "format", "length", "lenght", "ordinal", "character", "func_name",
+    "stringify", "printer", "returned", "forward", "iff", "els", "nill",
+    "counter_value", "loop_index", "result_accumulator", "float",
+};
+
+/**
+ * @brief Keyword recognition the scanner used before keyword_lookup
+ */
+static bool keyword_chain(const char *str, keyword *kw)
+{
+    if (strcmp(str, "int") == 0)            { *kw = KW_INT; }
+    else if (strcmp(str, "float64") == 0)   { *kw = KW_FLOAT64; }
+    else if (strcmp(str, "string") == 0)    { *kw = KW_STRING; }
+    else if (strcmp(str, "nil") == 0)       { *kw = KW_NIL; }
+    else if (strcmp(str, "_") == 0)         { *kw = KW_UNDERSCORE; }
+    else if (strcmp(str, "if") == 0)        { *kw = KW_IF; }
+    else if (strcmp(str, "else") == 0)      { *kw = KW_ELSE; }
+    else if (strcmp(str, "for") == 0)       { *kw = KW_FOR; }
+    else if (strcmp(str, "package") == 0)   { *kw = KW_PACKAGE; }
+    else if (strcmp(str, "func") == 0)      { *kw = KW_FUNC; }
+    else if (strcmp(str, "return") == 0)    { *kw = KW_RETURN; }
+    else if (strcmp(str, "print") == 0)     { *kw = KW_PRINT; }
+    else if (strcmp(str, "inputs") == 0)    { *kw = KW_INPUTS; }
+    else if (strcmp(str, "inputi") == 0)    { *kw = KW_INPUTI; }
+    else if (strcmp(str, "inputf") == 0)    { *kw = KW_INPUTF; }
+    else if (strcmp(str, "int2float") == 0) { *kw = KW_INT2FLOAT; }
+    else if (strcmp(str, "float2int") == 0) { *kw = KW_FLOAT2INT; }
+    else if (strcmp(str, "len") == 0)       { *kw = KW_LEN; }
+    else if (strcmp(str, "substr") == 0)    { *kw = KW_SUBSTR; }
+    else if (strcmp(str, "ord") == 0)       { *kw = KW_ORD; }
+    else if (strcmp(str, "chr") == 0)       { *kw = KW_CHR; }
+    else { return false; }
+    return true;
+}
+
+static double seconds(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main()
+{
+    unsigned int nkw = sizeof(keywords) / sizeof(*keywords);
+    unsigned int nid = sizeof(identifiers) / sizeof(*identifiers);
+
+    // every keyword is found and no identifier is taken for one
+    for (unsigned int i = 0; i < nkw; i++)
+    {
+        keyword a, b;
+        assert(keyword_lookup(keywords[i], strlen(keywords[i]), &a));
+        assert(keyword_chain(keywords[i], &b));
+        assert(a == b);
+    }
+    for (unsigned int i = 0; i < nid; i++)
+    {
+        keyword kw;
+        assert(!keyword_lookup(identifiers[i], strlen(identifiers[i]), &kw));
+        assert(!keyword_chain(identifiers[i], &kw));
+    }
+
+    // identifier-heavy word list, every eighth word is a keyword
+    static const char *words[WORDS];
+    static unsigned int lens[WORDS];
+    for (unsigned int i = 0; i < WORDS; i++)
+    {
+        words[i] = i % 8 == 0 ? keywords[(i / 8) % nkw] : identifiers[(i * 7) % nid];
+        lens[i] = strlen(words[i]);
+    }
+
+    unsigned long found = 0;
+    clock_t start = clock();
+    for (unsigned int r = 0; r < ROUNDS; r++)
+    {
+        for (unsigned int i = 0; i < WORDS; i++)
+        {
+            keyword kw;
+            found += keyword_chain(words[i], &kw);
+        }
+    }
+    double chain = seconds(start);
+
+    unsigned long found_lookup = 0;
+    start = clock();
+    for (unsigned int r = 0; r < ROUNDS; r++)
+    {
+        for (unsigned int i = 0; i < WORDS; i++)
+        {
+            keyword kw;
+            found_lookup += keyword_lookup(words[i], lens[i], &kw);
+        }
+    }
+    double lookup = seconds(start);
+    assert(found == found_lookup);
+
+    printf("%d words x %d rounds, %lu keywords found\n", WORDS, ROUNDS, found);
+    printf("strcmp chain:   %.3f s\n", chain);
+    printf("keyword_lookup: %.3f s\n", lookup);
+    return 0;
+}
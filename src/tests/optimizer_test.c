@@ -1,138 +1,109 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "../optimizer.h"
-#include "../dll.h"
 #include "../expression.h"
-//#include <stdlib.h>
-//#include "../dll.c"
-//#include "../optimizer.c"
-//#include "../str.c"
-
-int main() {
-    dll_t *list = dll_init();
-
-    symbol_t *symbol1 = (symbol_t*)malloc(sizeof(symbol_t));
-    long symbol1_data = 25;
-    long *symbol1_data_ptr = &symbol1_data;
-    symbol1->sym_type = SYM_INT;
-    symbol1->data = symbol1_data_ptr;
-
-    symbol_t *symbol2 = (symbol_t*)malloc(sizeof(symbol_t));
-    long symbol2_data = 5;
-    long *symbol2_data_ptr = &symbol2_data;
-    symbol2->sym_type = SYM_INT;
-    symbol2->data = symbol2_data_ptr;
-
-    symbol_t *symbol3 = (symbol_t*)malloc(sizeof(symbol_t));
-    o_type operator1 = S_SUB;
-    symbol3->sym_type = SYM_OPERATOR;
-    symbol3->data = &operator1;
-
-    dll_insert_first(list, symbol3);
-    dll_insert_first(list, symbol2);
-    dll_insert_first(list, symbol1);
-
-    data_t *data = malloc(sizeof(data_t));
-    data->current_type = 'i';
-
-    dll_node_t *tmp = list->first;
-    printf("\n");
-    while (tmp != NULL) {
-        switch (((symbol_t*)tmp->data)->sym_type) {
-            case SYM_INT:
-                printf("%ld ", *((long*)((symbol_t*)tmp->data)->data));
-                break;
-
-            case SYM_VAR:
-                printf("var ");
-                break;
-
-            case SYM_FLOAT64:
-                printf("%f ", *((double*)((symbol_t*)tmp->data)->data));
-                break;
-
-            case SYM_STRING:
-                printf("%s ", ((string*)((symbol_t*)tmp->data)->data)->str);
-                break;
-            
-            case SYM_OPERATOR:
-                switch (*((o_type*)((symbol_t*)tmp->data)->data)) {
-                    case S_ADD:
-                        printf("+ ");
-                        break;
-
-                    case S_SUB:
-                        printf("- ");
-                        break;
-
-                    case S_DIV:
-                        printf("/ ");
-                        break;
-
-                    case S_MUL:
-                        printf("* ");
-                        break;
-                        
-                    default:
-                        break;
-                }
-                break;
-            
-            default:
-                break;
+#include "../error.h"
+
+static var_data_t var_a, var_b;
+
+/**
+ * Fills the list from a postfix expression of integers, the variables a and b and + - * /.
+ */
+static void read_postfix(symbol_vector_t *list, const char *postfix)
+{
+    list->items = list->buffer;
+    list->count = 0;
+    list->size = SYMBOL_VECTOR_INLINE;
+
+    char copy[256];
+    strcpy(copy, postfix);
+    for (char *tok = strtok(copy, " "); tok != NULL; tok = strtok(NULL, " ")) {
+        symbol_t *symbol = &list->items[list->count++];
+        memset(symbol, 0, sizeof(symbol_t));
+        if (strcmp(tok, "a") == 0 || strcmp(tok, "b") == 0) {
+            symbol->sym_type = SYM_VAR;
+            symbol->data.var = tok[0] == 'a' ? &var_a : &var_b;
+        }
+        else if (strlen(tok) == 1 && strchr("+-*/", tok[0]) != NULL) {
+            symbol->sym_type = SYM_OPERATOR;
+            symbol->data.op = tok[0] == '+' ? S_ADD : tok[0] == '-' ? S_SUB : tok[0] == '*' ? S_MUL : S_DIV;
+        }
+        else {
+            symbol->sym_type = SYM_INT;
+            symbol->data.int_val = strtol(tok, NULL, 10);
         }
-        tmp = tmp->next;
     }
+}
 
-    if(optimize(list, data) != 0) return 1;
-
-    tmp = list->first;
-    printf("\n\n");
-    while (tmp != NULL) {
-        switch (((symbol_t*)tmp->data)->sym_type) {
+static void write_postfix(symbol_vector_t *list, char *out)
+{
+    out[0] = '\0';
+    for (unsigned int i = 0; i < list->count; i++) {
+        symbol_t *symbol = &list->items[i];
+        char item[32];
+        switch (symbol->sym_type) {
             case SYM_INT:
-                printf("%ld ", *((long*)((symbol_t*)tmp->data)->data));
+                sprintf(item, "%ld", symbol->data.int_val);
                 break;
 
             case SYM_VAR:
-                printf("var ");
-                break;
-
-            case SYM_FLOAT64:
-                printf("%f ", *((double*)((symbol_t*)tmp->data)->data));
-                break;
-
-            case SYM_STRING:
-                printf("%s ", ((string*)((symbol_t*)tmp->data)->data)->str);
+                strcpy(item, symbol->data.var == &var_a ? "a" : "b");
                 break;
 
             case SYM_OPERATOR:
-                switch (*((o_type*)((symbol_t*)tmp->data)->data)) {
-                    case S_ADD:
-                        printf("+ ");
-                        break;
-
-                    case S_SUB:
-                        printf("- ");
-                        break;
-
-                    case S_DIV:
-                        printf("/ ");
-                        break;
-
-                    case S_MUL:
-                        printf("* ");
-                        break;
-
-                    default:
-                        break;
-                }
+                sprintf(item, "%c", "+-*/"[symbol->data.op]);
                 break;
 
             default:
+                strcpy(item, "?");
                 break;
         }
-        tmp = tmp->next;
+        if (i > 0)
+            strcat(out, " ");
+        strcat(out, item);
     }
+}
 
+/**
+ * Optimizes an int expression and compares the result and the reduced expression.
+ */
+static int test(data_t *data, const char *postfix, int result, const char *expected)
+{
+    symbol_vector_t list;
+    char out[256];
+    read_postfix(&list, postfix);
+    int ret = optimize(data, &list);
+    write_postfix(&list, out);
+    if (ret != result || (ret == 0 && strcmp(out, expected) != 0)) {
+        printf("FAIL %s: %d [%s], expected %d [%s]\n", postfix, ret, out, result, expected);
+        return 1;
+    }
+    printf("OK   %s => %s\n", postfix, ret == 0 ? out : "error");
     return 0;
 }
+
+int main()
+{
+    data_t *data = calloc(1, sizeof(data_t));
+    if (data == NULL)
+        return 1;
+    data->current_type = 'i';
+    arena_init(&data->func_arena);
+
+    int failed = 0;
+    failed += test(data, "25 5 -", 0, "20");
+    failed += test(data, "a 0 /", ERR_ZERO_DIVISION, "");
+    // the divisor is not a constant, the operator before it must not be read as one
+    failed += test(data, "a b 1 + /", 0, "a b 1 + /");
+    failed += test(data, "a 1 + 2 +", 0, "a 3 +");
+    failed += test(data, "1 a + 2 +", 0, "3 a +");
+    failed += test(data, "5 a - 3 -", 0, "2 a -");
+    // the constant only starts the left operand, it is not c1 of (c1 - x) - c2
+    failed += test(data, "2 a - 2 / a - 10 -", 0, "2 a - 2 / a - 10 -");
+    failed += test(data, "2 a * b - 3 +", 0, "2 a * b - 3 +");
+
+    arena_free(&data->func_arena);
+    free(data);
+    return failed != 0;
+}
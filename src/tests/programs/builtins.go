@@ -0,0 +1,90 @@
+package main
+
+func probe(s string, i int, c int) {
+	o := 0
+	e := 0
+	o, e = ord(s, i)
+	print(o, " ", e, " ")
+	t := ""
+	t, e = chr(c)
+	print("[", t, "] ", e, " ")
+	n := 0
+	n = len(s)
+	f := 0.0
+	f = int2float(i)
+	k := 0
+	k = float2int(f)
+	print(n, " ", f, " ", k, "\n")
+}
+
+func main() {
+	s := "hello, world"
+	n := 0
+	n = len(s)
+	print(n, "\n")
+	a := ""
+	e := 0
+	a, e = substr(s, 7, 5)
+	print(a, e, "\n")
+	a, e = substr(s, 7, 100)
+	print(a, e, "\n")
+	a, e = substr(s, 12, 1)
+	print(a, e, "\n")
+	a, e = substr(s, 13, 1)
+	print(a, e, "\n")
+	m1 := 0 - 1
+	a, e = substr(s, m1, 1)
+	print(a, e, "\n")
+	a, e = substr(s, 0, m1)
+	print(a, e, "\n")
+	a, e = substr(s, 0, 0)
+	print("[", a, "]", e, "\n")
+	c := 0
+	c, e = ord(s, 0)
+	print(c, e, "\n")
+	c, e = ord(s, 11)
+	print(c, e, "\n")
+	c, e = ord(s, 12)
+	print(c, e, "\n")
+	c, e = ord(s, m1)
+	print(c, e, "\n")
+	a, e = chr(65)
+	print(a, e, "\n")
+	a, e = chr(256)
+	print(a, e, "\n")
+	a, e = chr(m1)
+	print(a, e, "\n")
+	f := 0.0
+	f = int2float(n)
+	print(f, "\n")
+	i := 0
+	i = float2int(3.75)
+	print(i, "\n")
+	mf := 0.0 - 3.75
+	i = float2int(mf)
+	print(i, "\n")
+	// the same builtins on values only known at run time
+	p := 0
+	q := 0
+	for j := 0; j < 5; j = j + 1 {
+		p, _ = inputi()
+		q, _ = inputi()
+		probe(s, p, q)
+	}
+	probe("", 0, 126)
+	x := 0
+	x, e = inputi()
+	print(x, e, "\n")
+	y := 0.0
+	y, e = inputf()
+	print(y, e, "\n")
+	z := ""
+	z, e = inputs()
+	print(z, e, "\n")
+	x, e = inputi()
+	print(x, e, "\n")
+	z, e = inputs()
+	print(z, e, "\n")
+	z, e = inputs()
+	print(z, e, "\n")
+}
@@ -0,0 +1,152 @@
+package main
+
+func main() {
+	x := 5
+	y := 0
+	y = twice(x)
+	print(x, " ", y, "\n")
+	a := 0
+	b := ""
+	a, b = pair(x, "s")
+	print(a, " ", b, "\n")
+	_, b = pair(7, "t")
+	print(b, "\n")
+	a, _ = pair(8, "u")
+	print(a, "\n")
+	for i := 0; i < 4; i = i + 1 {
+		y = nested(i)
+		print(y, " ")
+	}
+	print("\n")
+	y = fact(6)
+	print(y, "\n")
+	y = even(7)
+	print(y, "\n")
+	y = big(3)
+	print(y, "\n")
+	s := ""
+	s = sub("hello world", 3)
+	print(s, "\n")
+	y = noargs()
+	print(y, "\n")
+	z := 1
+	z = mod(z)
+	print(z, "\n")
+	y = twice(y)
+	y = twice(y)
+	print(y, "\n")
+	y = usefact(4)
+	print(y, "\n")
+}
+
+func twice(n int) (int) {
+	n = n * 2
+	return n
+}
+
+func pair(n int, s string) (int, string) {
+	if n > 6 {
+		return n, s + "!"
+	} else {
+		return n + 1, s
+	}
+}
+
+func nested(i int) (int) {
+	r := 0
+	r = twice(i)
+	r = twice(r)
+	return r + 1
+}
+
+func fact(n int) (int) {
+	if n < 2 {
+		return 1
+	} else {
+		r := 0
+		m := n - 1
+		r = fact(m)
+		return n * r
+	}
+}
+
+func even(n int) (int) {
+	if n == 0 {
+		return 1
+	} else {
+		r := 0
+		m := n - 1
+		r = odd(m)
+		return r
+	}
+}
+
+func odd(n int) (int) {
+	if n == 0 {
+		return 0
+	} else {
+		r := 0
+		m := n - 1
+		r = even(m)
+		return r
+	}
+}
+
+func big(n int) (int) {
+	s := 0
+	for i := 0; i < n; i = i + 1 {
+		s = s + i * i
+		if s > 100 {
+			s = s - 100
+		} else {
+			s = s + 1
+		}
+		for j := 0; j < 2; j = j + 1 {
+			s = s + j
+			s = s * 2
+			s = s - 1
+		}
+	}
+	t := 0
+	t = twice(s)
+	s = s + t
+	s = s + 1
+	s = s + 2
+	s = s + 3
+	s = s + 4
+	s = s + 5
+	s = s + 6
+	s = s + 7
+	s = s + 8
+	s = s + 9
+	s = s + 10
+	return s
+}
+
+func sub(s string, i int) (string) {
+	r := ""
+	e := 0
+	r, e = substr(s, i, 4)
+	if e == 0 {
+		return r
+	} else {
+		return "err"
+	}
+}
+
+func noargs() (int) {
+	return 42
+}
+
+func mod(z int) (int) {
+	z = z + 10
+	x := z * 2
+	return x
+}
+
+func usefact(n int) (int) {
+	r := 0
+	r = fact(n)
+	r = twice(r)
+	return r
+}
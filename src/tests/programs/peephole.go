@@ -0,0 +1,52 @@
+package main
+
+func main() {
+	a := 0
+	b := 0
+	a, _ = inputi()
+	b, _ = inputi()
+	a, b = b, a
+	c := a * b + (a - b) * (b + 1)
+	d := (a + 1) * (b + 2) * (a + 3) * (b + 4) * (a + b)
+	e := a * (b * (a * (b * (a * (b + 1)))))
+	s := "x"
+	s, _ = inputs()
+	t := s + "y" + s
+	u := "q" + (s + "r") + t
+	f := 0.5
+	f, _ = inputf()
+	g := f * 2.0 + f / 4.0
+	if f <= 1.0 {
+		print(c, " ", d, " ", e, " ", t, " ", u, " ", g, "\n")
+	} else {
+		print("big\n")
+	}
+	if a == b {
+		print("eq\n")
+	} else {
+		print("neq\n")
+	}
+	if a != 3 {
+		print("ne3\n")
+	} else {
+		print("is3\n")
+	}
+	if a >= b {
+		print("ge\n")
+	} else {
+		print("lt\n")
+	}
+	// nested deeper than there are registers for the pushed operands
+	h := (a + 1) * ((b + 2) * ((a + 3) * ((b + 4) * ((a + 5) * ((b + 6) - (a - 7))))))
+	k := (a - 1) - ((b - 2) - ((a - 3) - ((b - 4) - ((a - 5) - ((b - 6) - (a - 7))))))
+	print(h, " ", k, "\n")
+	for i := 0; i < a; i = i + 1 {
+		a = a - 1
+		print(i, a, "\n")
+	}
+	x := 0
+	x = x
+	x = a
+	a = x + a
+	print(a, x, "\n")
+}
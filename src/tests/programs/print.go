@@ -0,0 +1,35 @@
+package main
+
+func show(a int, b string) {
+	print("<", a, "|", b, ">")
+}
+
+func main() {
+	print()
+	print("\n")
+	x := 1
+	if x == 1 {
+		x := "in"
+		print(x, 2.5, "\n")
+	} else {
+	}
+	print(x, "\n")
+	s := "a\tb\"c\\d\x41"
+	f := 0.0 - 0.125
+	m := 0 - 7
+	print(s, " ", f, " ", m, " ", "#", "\n")
+	print(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, "\n")
+	for i := 0; i < 3; i = i + 1 {
+		show(i, s)
+		sq := i * i
+		print(sq, " ")
+	}
+	print("\n")
+	n := 0
+	n, _ = inputi()
+	t := ""
+	t, _ = inputs()
+	u := n + 1
+	v := t + t
+	print(n, t, u, v, "\n")
+}
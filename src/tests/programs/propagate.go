@@ -0,0 +1,89 @@
+package main
+
+func id(x int) (int) {
+	return x
+}
+
+func main() {
+	a := 3
+	b := a + 4
+	c := b * 2
+	print(c, "\n")
+	s := "ab"
+	t := s + "cd"
+	print(t, "\n")
+	f := 1.5
+	g := f * 2.0
+	print(g, "\n")
+	x, y := 1, 2
+	print(x, y, "\n")
+	x, y = y, x
+	print(x, y, "\n")
+	p := x
+	q := p + 1
+	print(q, "\n")
+	x = 10
+	print(p, q, "\n")
+	k := 0
+	if a > 2 {
+		k = 5
+	} else {
+		k = 6
+	}
+	print(k, "\n")
+	m := 0
+	n := 7
+	inp := 0
+	inp, _ = inputi()
+	if inp > 2 {
+		m = 1
+		n = 7
+	} else {
+		m = 2
+		n = 7
+	}
+	r := m + n
+	print(r, n, "\n")
+	if inp > 2 {
+		return
+	} else {
+		m = 9
+	}
+	r = m + 1
+	print(r, "\n")
+	sum := 0
+	lim := 5
+	for i := 0; i < lim; i = i + 1 {
+		sum = sum + i
+		lim2 := lim
+		print(lim2, " ")
+	}
+	print(sum, "\n")
+	w := 1
+	v := w
+	for j := 0; j < 3; j = j + 1 {
+		print(v, w, " ")
+		w = w + 1
+	}
+	print(v, w, "\n")
+	z := 0
+	z = id(5)
+	print(z, "\n")
+	u := 4
+	for e := 0; e < 3; e = e + u {
+		print(e, " ")
+	}
+	print("\n")
+	d := 0
+	if inp < 0 {
+		d = 1
+	} else {
+	}
+	zero := 0
+	if d == 0 {
+		print("fine\n")
+	} else {
+		h := 5 / zero
+		print(h, "\n")
+	}
+}
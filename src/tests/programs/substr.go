@@ -0,0 +1,70 @@
+package main
+
+func check(s string, i int, n int) {
+	r := ""
+	e := 0
+	r, e = substr(s, i, n)
+	print(r, "|", e, "\n")
+}
+
+func main() {
+	s := "abcdefghijklmnopqrstuvwxyz0123456789"
+	check(s, 0, 0)
+	check(s, 0, 1)
+	check(s, 3, 1)
+	check(s, 3, 2)
+	check(s, 3, 8)
+	check(s, 3, 9)
+	check(s, 3, 10)
+	check(s, 3, 17)
+	check(s, 0, 36)
+	check(s, 0, 100)
+	check(s, 5, 100)
+	check(s, 36, 0)
+	check(s, 36, 5)
+	check(s, 37, 0)
+	check(s, 35, 1)
+	check(s, 35, 2)
+	check(s, 1, 35)
+	check("", 0, 0)
+	check("", 0, 3)
+	check("", 1, 0)
+	check("x", 0, 1)
+	x := 0
+	x = 1 - 2
+	check(s, x, 2)
+	check(s, 2, x)
+	r := ""
+	e := 0
+	r, e = substr("hello world", 6, 5)
+	print(r, "|", e, "\n")
+	r, e = substr("hello world", 6, 50)
+	print(r, "|", e, "\n")
+	r, e = substr("hello world", 12, 1)
+	print(r, "|", e, "\n")
+	t := "const string here"
+	a := 2
+	r, e = substr(t, a, 4)
+	print(r, "|", e, "\n")
+	r, _ = substr(t, 0, 5)
+	print(r, "\n")
+	_, e = substr(t, 0, x)
+	print(e, "\n")
+	r, e = substr(s, a, 20)
+	print(r, "|", e, "\n")
+	// more than one chunk, the rest is copied a character at a time
+	big := ""
+	for k := 0; k < 100; k = k + 1 {
+		big = big + "0123456789"
+	}
+	r, e = substr(big, 3, 990)
+	n := 0
+	n = len(r)
+	print(n, "|", e, "\n")
+	r, e = substr(r, 980, 20)
+	print(r, "|", e, "\n")
+	u := ""
+	u, _ = inputs()
+	r, e = substr(u, 1, 3)
+	print(r, "|", e, "\n")
+}
@@ -0,0 +1,175 @@
+package main
+
+func sum(n int, acc int) int {
+	if n == 0 {
+		return acc
+	} else {
+		r := 0
+		m := n - 1
+		c := acc + n
+		r = sum(m, c)
+		return r
+	}
+}
+
+func fact(n int) int {
+	if n < 2 {
+		return 1
+	} else {
+		t := 0
+		m := n - 1
+		t = fact(m)
+		return n * t
+	}
+}
+
+func tri(n int) int {
+	if n == 0 {
+		return 0
+	} else {
+		t := 0
+		m := n - 1
+		t = tri(m)
+		return t + n
+	}
+}
+
+func even(n int) int {
+	if n == 0 {
+		return 1
+	} else {
+		r := 0
+		m := n - 1
+		r = odd(m)
+		return r
+	}
+}
+
+func odd(n int) int {
+	if n == 0 {
+		return 0
+	} else {
+		r := 0
+		m := n - 1
+		r = even(m)
+		return r
+	}
+}
+
+func divmod(a int, b int, q int) (int, int) {
+	if a < b {
+		return q, a
+	} else {
+		x := 0
+		y := 0
+		c := a - b
+		d := q + 1
+		x, y = divmod(c, b, d)
+		return x, y
+	}
+}
+
+func mixed(n int) int {
+	if n < 1 {
+		return 1
+	} else {
+		if n == 3 {
+			t := 0
+			m := n - 1
+			t = mixed(m)
+			return t + n
+		} else {
+			t := 0
+			m := n - 1
+			t = mixed(m)
+			return n * t
+		}
+	}
+}
+
+func cat(s string, n int) string {
+	if n == 0 {
+		return s
+	} else {
+		r := ""
+		m := n - 1
+		r = cat(s, m)
+		return r + "x"
+	}
+}
+
+func fl(x float64, n int) float64 {
+	if n == 0 {
+		return x
+	} else {
+		r := 0.0
+		m := n - 1
+		r = fl(x, m)
+		return r * 2.0
+	}
+}
+
+func g(n int, a int, b int) int {
+	if n == 0 {
+		return a*10 + b
+	} else {
+		r := 0
+		m := n - 1
+		r = g(m, b, a)
+		return r
+	}
+}
+
+func rot(n int, a int, b int, c int) string {
+	if n == 0 {
+		e := 0
+		s := ""
+		s, e = chr(a)
+		t := ""
+		t, e = chr(b)
+		u := ""
+		u, e = chr(c)
+		return s + t + u
+	} else {
+		r := ""
+		m := n - 1
+		r = rot(m, b, c, a)
+		return r
+	}
+}
+
+func main() {
+	a := 0
+	a = sum(1000, 0)
+	print(a, "\n")
+	a = fact(20)
+	print(a, "\n")
+	a = tri(500)
+	print(a, "\n")
+	b := 0
+	b = even(1001)
+	print(b, "\n")
+	q := 0
+	r := 0
+	q, r = divmod(1000, 7, 0)
+	print(q, " ", r, "\n")
+	a = mixed(6)
+	print(a, "\n")
+	s := ""
+	s = cat("a", 5)
+	print(s, "\n")
+	f := 0.0
+	f = fl(1.5, 4)
+	print(f, "\n")
+	x := 0
+	x = g(0, 1, 2)
+	print(x, " ")
+	x = g(1, 1, 2)
+	print(x, " ")
+	x = g(3, 1, 2)
+	print(x, "\n")
+	s = rot(1, 97, 98, 99)
+	print(s, " ")
+	s = rot(2, 97, 98, 99)
+	print(s, "\n")
+}
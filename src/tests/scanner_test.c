@@ -7,38 +7,17 @@
 #include "symtable.h"
 #include "stack.h"
 
-void print_tree(stnode_ptr TempTree, char* sufix, char fromdir)
+void print_table(symtable_ptr table)
 {
-    if (TempTree != NULL)
+    if (table != NULL)
     {
-        char* suf2 = (char*) malloc(strlen(sufix) + 4);
-        strcpy(suf2, sufix);
-        if (fromdir == 'L')
+        for (unsigned int i = 0; i < table->size; i++)
         {
-            suf2 = strcat(suf2, "  |");
-            printf("%s\n", suf2);
-        }
-        else
-        {
-            suf2 = strcat(suf2, "   ");
-        }
-        print_tree(TempTree->rnode, suf2, 'R');
-        printf("%s  +-[%s]\n", sufix, TempTree->key);
-        strcpy(suf2, sufix);
-        if (fromdir == 'R')
-        {
-            suf2 = strcat(suf2, "  |");
-        }
-        else
-        {
-            suf2 = strcat(suf2, "   ");
-        }
-        print_tree(TempTree->lnode, suf2, 'L');
-        if (fromdir == 'R')
-        {
-            printf("%s\n", suf2);
+            if (table->nodes[i].hash != 0)
+            {
+                printf("%4u +-[%s] dist %u\n", i, table->nodes[i].key, table->nodes[i].dist);
+            }
         }
-        free(suf2);
     }
 }
 
@@ -52,7 +31,9 @@ void print_tree(stnode_ptr TempTree, char* sufix, char fromdir)
             printf("Token long: %ld\n", tok->attr.int_val); \
         if (tok->type == TOKEN_FLOAT64) \
             printf("Token float64: %f\n", tok->attr.float64_val); \
-        if (tok->type == TOKEN_IDENTIFIER || tok->type == TOKEN_STRING) \
+        if (tok->type == TOKEN_IDENTIFIER) \
+            printf("Token id: %s\n", tok->attr.id->str); \
+        if (tok->type == TOKEN_STRING) \
             printf("Token str: %s\n", tok->attr.str->str); \
         if (tok->type == TOKEN_KEYWORD) \
             printf("Token kw: %d\n", tok->attr.kw);
@@ -77,7 +58,7 @@ void print_tree(stnode_ptr TempTree, char* sufix, char fromdir)
         PRINT_VALS() \
         assert(result == SCANNER_SUCCESS); \
         assert(tok->type == TOKEN_IDENTIFIER); \
-        assert(str_cmp_const(tok->attr.str, STR) == 0);
+        assert(strcmp(tok->attr.id->str, STR) == 0);
 
 #define STR(STRV) NEXT_TOKEN() \
         PRINT_VALS() \
@@ -100,7 +81,7 @@ int main(int argc, char *argv[])
         str_init(&s);
         set_token_string_attr(&s);
         token tok;
-        stnode_ptr tree;
+        symtable_ptr tree;
         symtable_init(&tree);
         do
         {
@@ -115,8 +96,8 @@ int main(int argc, char *argv[])
                 printf("Token float64: %f\n", tok.attr.float64_val);
             if (tok.type == TOKEN_IDENTIFIER)
             {
-                printf("Token str: %s\n", tok.attr.str->str);
-                stnode_ptr new = symtable_insert(&tree, tok.attr.str->str, &err);
+                printf("Token id: %s\n", tok.attr.id->str);
+                stnode_ptr new = symtable_insert_hash(&tree, tok.attr.id->str, tok.attr.id->hash, &err);
                 if (new != NULL){
                     new->data = malloc(sizeof(struct stdata));
                 }
@@ -124,7 +105,7 @@ int main(int argc, char *argv[])
             if (tok.type == TOKEN_KEYWORD)
                 printf("Token kw: %d\n", tok.attr.kw);
         } while (tok.type != TOKEN_EOF);
-        print_tree(tree, "", 'X');
+        print_table(tree);
 
         stnode_ptr del = symtable_search(tree, "main");
         if (del != NULL)
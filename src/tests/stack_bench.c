@@ -0,0 +1,157 @@
+/**
+ * Project name: Imperative language IFJ20 compiler implementation
+ * Název projektu: Implementace překladače imperativního jazyka IFJ20
+ *
+ * @brief Stack benchmark
+ *
+ * Replays the push/pop pattern of the precedence parser: many short
+ * expressions with a shallow stack that is emptied after each one, and
+ * one deep stack like the declaration log of a long function. The linked
+ * stack used before is timed alongside.
+ *
+ * @author Petr Kabelka <xkabel09 at stud.fit.vutbr.cz>
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <time.h>
+#include "../stack.h"
+
+#define EXPRESSIONS 1000000
+#define EXPRESSION_DEPTH 8
+#define DEEP 10000000
+
+/**
+ * @brief Linked stack the parser used before
+ */
+struct stack_el
+{
+    struct stack_el *next;
+    void *data;
+};
+
+typedef struct
+{
+    struct stack_el *top;
+    unsigned int count;
+} linked_stack;
+
+static bool linked_push(linked_stack *s, void *data)
+{
+    struct stack_el *tmp = malloc(sizeof(struct stack_el));
+    if (tmp == NULL)
+    {
+        return false;
+    }
+    tmp->next = s->top;
+    tmp->data = data;
+    s->top = tmp;
+    s->count += 1;
+    return true;
+}
+
+static void *linked_pop(linked_stack *s)
+{
+    struct stack_el *tmp = s->top;
+    void *data = tmp->data;
+    s->top = tmp->next;
+    s->count -= 1;
+    free(tmp);
+    return data;
+}
+
+static double seconds(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static double bench_linked(unsigned int n, unsigned int depth)
+{
+    linked_stack s = {NULL, 0};
+    clock_t start = clock();
+    for (unsigned int i = 0; i < n; i++)
+    {
+        for (unsigned long d = 0; d < depth; d++)
+        {
+            assert(linked_push(&s, (void*)d));
+        }
+        for (unsigned long d = depth; d-- > 0;)
+        {
+            assert(linked_pop(&s) == (void*)d);
+        }
+    }
+    return seconds(start);
+}
+
+static double bench_array(unsigned int n, unsigned int depth)
+{
+    stack s;
+    stack_init(&s);
+    clock_t start = clock();
+    for (unsigned int i = 0; i < n; i++)
+    {
+        for (unsigned long d = 0; d < depth; d++)
+        {
+            assert(stack_push(&s, (void*)d));
+        }
+        for (unsigned long d = depth; d-- > 0;)
+        {
+            assert(stack_top(&s) == (void*)d);
+            stack_pop(&s, stack_nofree);
+        }
+    }
+    double elapsed = seconds(start);
+    stack_dispose(&s, stack_nofree);
+    return elapsed;
+}
+
+static unsigned int freed;
+
+static void count_free(void *data)
+{
+    (void)data;
+    freed++;
+}
+
+/**
+ * @brief Checks the stack semantics the parser relies on
+ */
+static void check_stack()
+{
+    stack s;
+    stack_init(&s);
+    assert(stack_top(&s) == NULL && s.count == 0);
+    stack_pop(&s, count_free); // popping an empty stack does nothing
+    assert(freed == 0);
+
+    for (unsigned long i = 1; i <= 1000; i++)
+    {
+        assert(stack_push(&s, (void*)i));
+        assert(stack_top(&s) == (void*)i && s.count == i);
+    }
+    for (unsigned long i = 1000; i > 500; i--)
+    {
+        assert(stack_top(&s) == (void*)i);
+        stack_pop(&s, count_free);
+    }
+    assert(freed == 500 && s.count == 500);
+
+    stack_clear(&s, count_free);
+    assert(freed == 1000 && s.count == 0 && s.items != NULL);
+    assert(stack_push(&s, (void*)1) && stack_top(&s) == (void*)1);
+
+    stack_dispose(&s, count_free);
+    assert(freed == 1001 && s.count == 0 && s.items == NULL);
+}
+
+int main()
+{
+    check_stack();
+
+    printf("%-28s %10s %10s\n", "", "linked", "array");
+    printf("%-28s %10.3f %10.3f\n", "1M expressions of depth 8",
+        bench_linked(EXPRESSIONS, EXPRESSION_DEPTH), bench_array(EXPRESSIONS, EXPRESSION_DEPTH));
+    printf("%-28s %10.3f %10.3f\n", "10M pushes, then 10M pops",
+        bench_linked(1, DEEP), bench_array(1, DEEP));
+    return 0;
+}
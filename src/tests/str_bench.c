@@ -0,0 +1,99 @@
+/**
+ * Project name: Imperative language IFJ20 compiler implementation
+ * Název projektu: Implementace překladače imperativního jazyka IFJ20
+ *
+ * @brief Dynamic string append benchmark
+ *
+ * Builds IFJcode20 output of growing size the way codegen does and prints
+ * the time per megabyte, which stays flat when appending is linear. The
+ * exact-size growth with strcat the string module used before is timed
+ * alongside as a reference.
+ *
+ * @author Petr Kabelka <xkabel09 at stud.fit.vutbr.cz>
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <time.h>
+#include "../str.h"
+
+#define MB (1024 * 1024)
+
+/**
+ * @brief Appends cstr the way str_add_var did before, growing to the exact size
+ */
+static bool old_add(string *s, const char *cstr)
+{
+    unsigned int cstr_len = (unsigned int)strlen(cstr);
+    if ((s->len + cstr_len + 1) >= s->mem_size)
+    {
+        if ((s->str = (char*) realloc(s->str, (s->len + cstr_len + 1) * sizeof(char))) == NULL)
+        {
+            return false;
+        }
+        s->mem_size = s->len + cstr_len + 1;
+    }
+
+    s->len += cstr_len;
+    strcat(s->str, cstr);
+    return true;
+}
+
+/**
+ * @brief Appends one function worth of instructions
+ */
+static bool emit(string *s, unsigned int i, bool old)
+{
+    char num[16];
+    sprintf(num, "%u", i);
+    const char *parts[] = {
+        "LABEL $f", num, "\n", "PUSHFRAME\n", "DEFVAR LF@%retval1\n",
+        "DEFVAR LF@x%", num, "\n", "MOVE LF@x%", num, " int@", num, "\n",
+        "PUSHS LF@x%", num, "\n", "PUSHS int@2\n", "MULS\n", "POPS LF@%retval1\n",
+        "POPFRAME\n", "RETURN\n",
+    };
+    for (unsigned int j = 0; j < sizeof(parts) / sizeof(*parts); j++)
+    {
+        if (old ? !old_add(s, parts[j]) : !str_add_var(s, parts[j], NULL))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Builds at least size bytes of output and returns the elapsed seconds
+ */
+static double build(unsigned int size, bool old)
+{
+    string s;
+    assert(str_init(&s));
+    clock_t start = clock();
+    for (unsigned int i = 0; s.len < size; i++)
+    {
+        assert(emit(&s, i, old));
+    }
+    double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+    assert(strlen(s.str) == s.len);
+    str_free(&s);
+    return elapsed;
+}
+
+int main()
+{
+    printf("%8s %12s %12s\n", "size", "s", "s/MB");
+    for (unsigned int mb = 4; mb <= 64; mb *= 2)
+    {
+        double t = build(mb * MB, false);
+        printf("%6u MB %12.4f %12.4f\n", mb, t, t / mb);
+    }
+
+    printf("exact growth with strcat:\n");
+    for (unsigned int kb = 128; kb <= 1024; kb *= 2)
+    {
+        double t = build(kb * 1024, true);
+        printf("%6u kB %12.4f %12.4f\n", kb, t, t * 1024 / kb);
+    }
+    return 0;
+}
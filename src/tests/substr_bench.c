@@ -0,0 +1,423 @@
+/**
+ * Project name: Imperative language IFJ20 compiler implementation
+ * Název projektu: Implementace překladače imperativního jazyka IFJ20
+ *
+ * @brief substr builtin benchmark
+ *
+ * Runs the $substr body the generator outputs on a small interpreter of the
+ * instructions it uses and prints the number of executed instructions and
+ * the time for substrings of 1, 100 and 10000 characters. The body that
+ * appended one character per iteration is run alongside as a reference.
+ *
+ * @author Petr Kabelka <xkabel09 at stud.fit.vutbr.cz>
+ */
+
+#define _POSIX_C_SOURCE 200809L // fileno
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include "../codegen.h"
+
+#define MAX_INSTRS 256
+#define MAX_VARS 16
+#define SOURCE_LEN 20000
+
+/**
+ * @brief The $substr body before the chunked copy
+ */
+static const char *old_substr =
+"LABEL $substr\n"\
+"PUSHFRAME\n"\
+"DEFVAR LF@%retval1\n"\
+"MOVE LF@%retval1 int@0\n"\
+"DEFVAR LF@index\n"\
+"MOVE LF@index int@1\n"\
+"DEFVAR LF@tmp\n"\
+"DEFVAR LF@%retval0\n"\
+"MOVE LF@%retval0 string@\n"\
+"STRLEN LF@tmp LF@%0\n"\
+"LT LF@%retval1 LF@%1 int@0\n"\
+"JUMPIFEQ $substr$error LF@%retval1 bool@true\n"\
+"GT LF@%retval1 LF@%1 LF@tmp\n"\
+"JUMPIFEQ $substr$error LF@%retval1 bool@true\n"\
+"LT LF@%retval1 LF@%2 int@0\n"\
+"JUMPIFEQ $substr$error LF@%retval1 bool@true\n"\
+"SUB LF@tmp LF@tmp LF@%1\n"\
+"GT LF@%retval1 LF@%2 LF@tmp\n"\
+"JUMPIFEQ $substr$isgreater LF@%retval1 bool@true\n"\
+"LABEL $substr$continue\n"\
+"JUMPIFEQ $substr$end LF@%2 int@0\n"\
+"GETCHAR LF@%retval0 LF@%0 LF@%1\n"\
+"JUMPIFEQ $substr$end LF@%2 int@1\n"\
+"LABEL $substr$cycle\n"\
+"ADD LF@%1 LF@%1 int@1\n"\
+"ADD LF@index LF@index int@1\n"\
+"GETCHAR LF@tmp LF@%0 LF@%1\n"\
+"CONCAT LF@%retval0 LF@%retval0 LF@tmp\n"\
+"JUMPIFNEQ $substr$cycle LF@index LF@%2\n"\
+"LABEL $substr$end\n"\
+"MOVE LF@%retval1 int@0\n"\
+"POPFRAME\n"\
+"RETURN\n"\
+"LABEL $substr$error\n"\
+"MOVE LF@%retval1 int@1\n"\
+"POPFRAME\n"\
+"RETURN\n"\
+"LABEL $substr$isgreater\n"\
+"MOVE LF@%2 LF@tmp\n"\
+"JUMP $substr$continue\n";
+
+typedef struct
+{
+    bool is_str;
+    long num; // int, or 0 and 1 for bool
+    char *str; // malloc allocated
+    size_t len;
+} value;
+
+typedef struct
+{
+    int var; // index of the variable, -1 for a constant
+    value val; // the constant or the index of the jump target
+    char name[32];
+} operand;
+
+typedef struct
+{
+    char op[16];
+    int nargs;
+    operand args[3];
+} instr;
+
+typedef struct
+{
+    instr code[MAX_INSTRS];
+    int count;
+    char vars[MAX_VARS][32];
+    int nvars;
+    value frame[MAX_VARS];
+} program;
+
+static int var_index(program *p, const char *name)
+{
+    for (int i = 0; i < p->nvars; i++)
+    {
+        if (strcmp(p->vars[i], name) == 0)
+        {
+            return i;
+        }
+    }
+    assert(p->nvars < MAX_VARS);
+    strcpy(p->vars[p->nvars], name);
+    return p->nvars++;
+}
+
+/**
+ * @brief Loads IFJcode20 text, comment and empty lines are skipped
+ */
+static void load(program *p, const char *text)
+{
+    memset(p, 0, sizeof(program));
+    char line[128];
+    while (*text != '\0')
+    {
+        size_t len = strcspn(text, "\n");
+        assert(len < sizeof(line));
+        memcpy(line, text, len);
+        line[len] = '\0';
+        text += len + (text[len] == '\n');
+        if (len == 0 || line[0] == '#')
+        {
+            continue;
+        }
+
+        assert(p->count < MAX_INSTRS);
+        instr *in = &p->code[p->count++];
+        char *word = strtok(line, " ");
+        strcpy(in->op, word);
+        while ((word = strtok(NULL, " ")) != NULL)
+        {
+            operand *o = &in->args[in->nargs++];
+            strcpy(o->name, word);
+            o->var = -1;
+            if (strncmp(word, "LF@", 3) == 0)
+            {
+                o->var = var_index(p, word + 3);
+            }
+            else if (strncmp(word, "int@", 4) == 0)
+            {
+                o->val.num = strtol(word + 4, NULL, 10);
+            }
+            else if (strncmp(word, "bool@", 5) == 0)
+            {
+                o->val.num = strcmp(word + 5, "true") == 0;
+            }
+            else if (strncmp(word, "string@", 7) == 0)
+            {
+                assert(word[7] == '\0'); // the bodies use only the empty string
+                o->val.is_str = true;
+                o->val.str = "";
+            }
+        }
+    }
+
+    // jump targets
+    for (int i = 0; i < p->count; i++)
+    {
+        if (strncmp(p->code[i].op, "JUMP", 4) != 0 && strcmp(p->code[i].op, "CALL") != 0)
+        {
+            continue;
+        }
+        operand *o = &p->code[i].args[0];
+        o->val.num = -1;
+        for (int j = 0; j < p->count; j++)
+        {
+            if (strcmp(p->code[j].op, "LABEL") == 0 && strcmp(p->code[j].args[0].name, o->name) == 0)
+            {
+                o->val.num = j;
+            }
+        }
+        assert(o->val.num >= 0);
+    }
+}
+
+static value *get(program *p, operand *o)
+{
+    return o->var < 0 ? &o->val : &p->frame[o->var];
+}
+
+static void set_num(program *p, operand *o, long num)
+{
+    value *v = &p->frame[o->var];
+    if (v->is_str)
+    {
+        free(v->str);
+    }
+    v->is_str = false;
+    v->num = num;
+}
+
+static void set_str(program *p, operand *o, char *str, size_t len)
+{
+    value *v = &p->frame[o->var];
+    if (v->is_str)
+    {
+        free(v->str);
+    }
+    v->is_str = true;
+    v->str = str;
+    v->len = len;
+}
+
+static char *copy(const char *str, size_t len)
+{
+    char *s = malloc(len + 1);
+    assert(s != NULL);
+    memcpy(s, str, len);
+    s[len] = '\0';
+    return s;
+}
+
+static bool equal(value *a, value *b)
+{
+    if (a->is_str)
+    {
+        return a->len == b->len && memcmp(a->str, b->str, a->len) == 0;
+    }
+    return a->num == b->num;
+}
+
+/**
+ * @brief Calls the body with the arguments s, i and n
+ * @return Number of executed instructions
+ */
+static long run(program *p, const char *s, long i, long n, char **result, size_t *result_len, long *err)
+{
+    for (int v = 0; v < p->nvars; v++)
+    {
+        p->frame[v].is_str = false;
+    }
+    operand arg;
+    arg.var = var_index(p, "%0");
+    set_str(p, &arg, copy(s, strlen(s)), strlen(s));
+    arg.var = var_index(p, "%1");
+    set_num(p, &arg, i);
+    arg.var = var_index(p, "%2");
+    set_num(p, &arg, n);
+
+    long steps = 0;
+    for (int pc = 0; ; pc++)
+    {
+        instr *in = &p->code[pc];
+        operand *a = in->args;
+        steps++;
+        if (strcmp(in->op, "RETURN") == 0)
+        {
+            break;
+        }
+        else if (strcmp(in->op, "MOVE") == 0)
+        {
+            value *src = get(p, &a[1]);
+            if (src->is_str)
+            {
+                set_str(p, &a[0], copy(src->str, src->len), src->len);
+            }
+            else
+            {
+                set_num(p, &a[0], src->num);
+            }
+        }
+        else if (strcmp(in->op, "STRLEN") == 0)
+        {
+            set_num(p, &a[0], get(p, &a[1])->len);
+        }
+        else if (strcmp(in->op, "LT") == 0)
+        {
+            set_num(p, &a[0], get(p, &a[1])->num < get(p, &a[2])->num);
+        }
+        else if (strcmp(in->op, "GT") == 0)
+        {
+            set_num(p, &a[0], get(p, &a[1])->num > get(p, &a[2])->num);
+        }
+        else if (strcmp(in->op, "ADD") == 0)
+        {
+            set_num(p, &a[0], get(p, &a[1])->num + get(p, &a[2])->num);
+        }
+        else if (strcmp(in->op, "SUB") == 0)
+        {
+            set_num(p, &a[0], get(p, &a[1])->num - get(p, &a[2])->num);
+        }
+        else if (strcmp(in->op, "MUL") == 0)
+        {
+            set_num(p, &a[0], get(p, &a[1])->num * get(p, &a[2])->num);
+        }
+        else if (strcmp(in->op, "IDIV") == 0)
+        {
+            set_num(p, &a[0], get(p, &a[1])->num / get(p, &a[2])->num);
+        }
+        else if (strcmp(in->op, "GETCHAR") == 0)
+        {
+            value *str = get(p, &a[1]);
+            long idx = get(p, &a[2])->num;
+            assert(idx >= 0 && (size_t)idx < str->len);
+            set_str(p, &a[0], copy(str->str + idx, 1), 1);
+        }
+        else if (strcmp(in->op, "CONCAT") == 0)
+        {
+            value *x = get(p, &a[1]), *y = get(p, &a[2]);
+            char *str = malloc(x->len + y->len + 1);
+            assert(str != NULL);
+            memcpy(str, x->str, x->len);
+            memcpy(str + x->len, y->str, y->len + 1);
+            set_str(p, &a[0], str, x->len + y->len);
+        }
+        else if (strcmp(in->op, "JUMP") == 0)
+        {
+            pc = a[0].val.num;
+        }
+        else if (strcmp(in->op, "JUMPIFEQ") == 0 || strcmp(in->op, "JUMPIFNEQ") == 0)
+        {
+            if (equal(get(p, &a[1]), get(p, &a[2])) == (in->op[6] == 'E'))
+            {
+                pc = a[0].val.num;
+            }
+        }
+        else
+        {
+            // LABEL, PUSHFRAME, POPFRAME and DEFVAR do nothing here
+            assert(strcmp(in->op, "LABEL") == 0 || strcmp(in->op, "PUSHFRAME") == 0
+                || strcmp(in->op, "POPFRAME") == 0 || strcmp(in->op, "DEFVAR") == 0);
+        }
+    }
+
+    value *retval0 = &p->frame[var_index(p, "%retval0")];
+    *result_len = retval0->len;
+    *result = copy(retval0->str, retval0->len);
+    *err = p->frame[var_index(p, "%retval1")].num;
+    for (int v = 0; v < p->nvars; v++)
+    {
+        if (p->frame[v].is_str)
+        {
+            free(p->frame[v].str);
+        }
+    }
+    return steps;
+}
+
+/**
+ * @brief Returns the $substr body the generator outputs
+ */
+static char *new_substr()
+{
+    assert(gen_codegen_init());
+    rope_clear(&ifjcode20_output); // without the header
+    assert(gen_builtin_function("substr"));
+
+    FILE *f = tmpfile();
+    assert(f != NULL);
+    assert(rope_write(&ifjcode20_output, fileno(f)));
+    long size = ftell(f);
+    rewind(f);
+    char *text = malloc(size + 1);
+    assert(text != NULL && fread(text, 1, size, f) == (size_t)size);
+    text[size] = '\0';
+    fclose(f);
+    gen_codegen_free();
+    return text;
+}
+
+/**
+ * @brief Runs both bodies on substr(s, i, n) and prints the executed instructions and the time
+ */
+static void bench(program *old, program *new, const char *s, long i, long n)
+{
+    char *old_result, *new_result;
+    size_t old_len, new_len;
+    long old_err, new_err;
+
+    clock_t start = clock();
+    long old_steps = run(old, s, i, n, &old_result, &old_len, &old_err);
+    double old_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+    start = clock();
+    long new_steps = run(new, s, i, n, &new_result, &new_len, &new_err);
+    double new_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    assert(old_err == new_err && old_len == new_len && memcmp(old_result, new_result, old_len) == 0);
+    printf("%6ld %6ld %6ld %12ld %12ld %10.4f %10.4f\n", i, n, (long)new_len, old_steps, new_steps, old_time, new_time);
+    free(old_result);
+    free(new_result);
+}
+
+int main()
+{
+    static program old, new;
+    char *text = new_substr();
+    load(&old, old_substr);
+    load(&new, text);
+    free(text);
+
+    char *s = malloc(SOURCE_LEN + 1);
+    assert(s != NULL);
+    for (int i = 0; i < SOURCE_LEN; i++)
+    {
+        s[i] = 'a' + i % 26;
+    }
+    s[SOURCE_LEN] = '\0';
+
+    printf("%6s %6s %6s %12s %12s %10s %10s\n", "i", "n", "len", "old instrs", "new instrs", "old s", "new s");
+    long lengths[] = { 1, 100, 10000 };
+    for (size_t k = 0; k < sizeof(lengths) / sizeof(lengths[0]); k++)
+    {
+        bench(&old, &new, s, 1, lengths[k]);
+    }
+
+    printf("prefix, whole string, past the end and error:\n");
+    bench(&old, &new, s, 0, 10000);
+    bench(&old, &new, s + SOURCE_LEN - 10000, 0, 10000);
+    bench(&old, &new, s, SOURCE_LEN - 5, 100);
+    bench(&old, &new, s, -1, 5);
+    free(s);
+    return 0;
+}
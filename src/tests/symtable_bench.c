@@ -0,0 +1,210 @@
+/**
+ * Project name: Imperative language IFJ20 compiler implementation
+ * Název projektu: Implementace překladače imperativního jazyka IFJ20
+ *
+ * @brief Symbol table benchmark
+ *
+ * Inserts and looks up 100k function names in the sorted order generated
+ * programs declare them in and 100k variable names in random order. The
+ * binary search tree the symbol table used before is timed alongside. As
+ * sorted insertion makes the tree a linked list, that case runs on a tenth
+ * of the names only.
+ *
+ * @author Petr Kabelka <xkabel09 at stud.fit.vutbr.cz>
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <time.h>
+#include "../symtable.h"
+
+#define NAMES 100000
+#define ROUNDS 10
+
+/**
+ * @brief Binary search tree node the symbol table used before
+ */
+typedef struct bst_node {
+    char *key;
+    void *data;
+    struct bst_node *lnode;
+    struct bst_node *rnode;
+} bst_node;
+
+static bst_node *bst_insert(bst_node **root, const char *key)
+{
+    while (*root != NULL)
+    {
+        int comp = strcmp((*root)->key, key);
+        if (comp == 0)
+        {
+            return NULL;
+        }
+        root = comp > 0 ? &(*root)->lnode : &(*root)->rnode;
+    }
+    bst_node *new = malloc(sizeof(bst_node));
+    assert(new != NULL);
+    new->key = malloc(strlen(key) + 1);
+    assert(new->key != NULL);
+    strcpy(new->key, key);
+    new->data = NULL;
+    new->lnode = NULL;
+    new->rnode = NULL;
+    *root = new;
+    return new;
+}
+
+static bst_node *bst_search(bst_node *root, const char *key)
+{
+    while (root != NULL)
+    {
+        int comp = strcmp(key, root->key);
+        if (comp == 0)
+        {
+            return root;
+        }
+        root = comp < 0 ? root->lnode : root->rnode;
+    }
+    return NULL;
+}
+
+static void bst_dispose(bst_node *root)
+{
+    // the degenerated tree is too deep for recursion on the right side
+    while (root != NULL)
+    {
+        bst_dispose(root->lnode);
+        bst_node *next = root->rnode;
+        free(root->key);
+        free(root);
+        root = next;
+    }
+}
+
+static void nofree(void *ptr)
+{
+    (void)ptr;
+}
+
+static char *copy(const char *s)
+{
+    char *c = malloc(strlen(s) + 1);
+    assert(c != NULL);
+    return strcpy(c, s);
+}
+
+static double seconds(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static double bench_bst(char **names, unsigned int n)
+{
+    bst_node *root = NULL;
+    clock_t start = clock();
+    for (unsigned int i = 0; i < n; i++)
+    {
+        assert(bst_insert(&root, names[i]) != NULL);
+    }
+    for (unsigned int r = 0; r < ROUNDS; r++)
+    {
+        for (unsigned int i = 0; i < n; i++)
+        {
+            assert(bst_search(root, names[i]) != NULL);
+        }
+    }
+    double elapsed = seconds(start);
+    bst_dispose(root);
+    return elapsed;
+}
+
+static double bench_table(char **names, unsigned int n)
+{
+    bool err;
+    symtable_ptr table;
+    symtable_init(&table);
+    clock_t start = clock();
+    for (unsigned int i = 0; i < n; i++)
+    {
+        assert(symtable_insert(&table, names[i], &err) != NULL && !err);
+    }
+    for (unsigned int r = 0; r < ROUNDS; r++)
+    {
+        for (unsigned int i = 0; i < n; i++)
+        {
+            assert(symtable_search(table, names[i]) != NULL);
+        }
+    }
+    double elapsed = seconds(start);
+    symtable_dispose(&table, nofree);
+    return elapsed;
+}
+
+/**
+ * @brief Checks the table against the expected content after inserts and deletes
+ */
+static void check_table(char **names, unsigned int n)
+{
+    bool err;
+    symtable_ptr table;
+    symtable_init(&table);
+    for (unsigned int i = 0; i < n; i++)
+    {
+        stnode_ptr node = symtable_insert(&table, names[i], &err);
+        assert(node != NULL && !err && strcmp(node->key, names[i]) == 0);
+        node->data = names[i];
+    }
+    assert(symtable_insert(&table, names[0], &err) == NULL && !err);
+    for (unsigned int i = 0; i < n; i += 2)
+    {
+        symtable_delete_node(&table, names[i], nofree);
+    }
+    for (unsigned int i = 0; i < n; i++)
+    {
+        stnode_ptr node = symtable_search(table, names[i]);
+        assert(i % 2 == 0 ? node == NULL : node != NULL && node->data == names[i]);
+    }
+    assert(table->count == n / 2);
+    symtable_dispose(&table, nofree);
+    assert(table == NULL);
+}
+
+int main()
+{
+    static char *funcs[NAMES];
+    static char *vars[NAMES];
+    char buf[64];
+    for (unsigned int i = 0; i < NAMES; i++)
+    {
+        sprintf(buf, "function_%06u", i);
+        funcs[i] = copy(buf);
+        sprintf(buf, "v%u", i);
+        vars[i] = copy(buf);
+    }
+
+    // shuffle the variables
+    srand(42);
+    for (unsigned int i = NAMES - 1; i > 0; i--)
+    {
+        unsigned int j = rand() % (i + 1);
+        char *tmp = vars[i];
+        vars[i] = vars[j];
+        vars[j] = tmp;
+    }
+
+    check_table(funcs, NAMES);
+    check_table(vars, NAMES);
+
+    printf("insert and %d lookups of each name\n", ROUNDS);
+    printf("%-24s %10s %10s\n", "", "bst", "hash");
+    printf("%-24s %10.3f %10.3f\n", "100k random variables", bench_bst(vars, NAMES), bench_table(vars, NAMES));
+    printf("%-24s %10.3f %10.3f\n", "10k sorted functions", bench_bst(funcs, NAMES / 10), bench_table(funcs, NAMES / 10));
+    printf("%-24s %10s %10.3f\n", "100k sorted functions", "-", bench_table(funcs, NAMES));
+
+    for (unsigned int i = 0; i < NAMES; i++)
+    {
+        free(funcs[i]);
+        free(vars[i]);
+    }
+    return 0;
+}